@@ -0,0 +1,30 @@
+#!/bin/sh
+#
+#  Compares two `loopbench` results files and fails if the median or the p99 awake cycles per
+#  loop() iteration, or the share of the run spent awake, of any sketch grew by more than
+#  THRESHOLD percent (default: 5).
+#
+#  Usage: `$ ./compare.sh baseline.tsv results.tsv`
+
+if [ $# -ne 2 ]; then
+    echo "usage: $0 baseline.tsv results.tsv" >&2
+    exit 2
+fi
+
+awk -F '\t' -v threshold="${THRESHOLD:-5}" '
+function change(old, new) { return old ? 100.0 * (new - old) / old : 0 }
+FNR == 1 { next }
+NR == FNR { median[$1] = $4; p99[$1] = $5; awake[$1] = $7; next }
+!($1 in median) { printf "%-14s (new)\n", $1; next }
+{
+    dm = change(median[$1], $4)
+    dp = change(p99[$1], $5)
+    da = change(awake[$1], $7)
+    bad = dm > threshold || dp > threshold || da > threshold
+    failed += bad
+    printf "%-14s median %9d -> %9d (%+6.1f%%)   p99 %9d -> %9d (%+6.1f%%)   " \
+        "awake %6.2f%% -> %6.2f%% (%+6.1f%%)%s\n",
+        $1, median[$1], $4, dm, p99[$1], $5, dp, awake[$1], $7, da, bad ? "   REGRESSION" : ""
+}
+END { exit failed ? 1 : 0 }
+' "$1" "$2"
@@ -0,0 +1,252 @@
+/*
+ *  Runs a sketch's ELF on a simulated ATmega328P (simavr) and measures the number of CPU
+ *  cycles spent awake in each `loop()` iteration, and the share of the run spent awake.
+ *
+ *  Iterations are delimited by `Bench::markLoop()` (see `common/bench.h`), which writes to
+ *  GPIOR0 right before every call to `loop()`. The cycles simavr skips while the CPU sleeps
+ *  (`Tasks::idle()`, see `common/scheduler.h`) aren't counted, so an iteration that only
+ *  sleeps until the next interrupt costs what waking up and that interrupt cost, not the time
+ *  until it came. Pins and ADC channels are driven from a stimulus script, so every run of the
+ *  same firmware sees the same input.
+ *
+ *  Usage: `$ loopbench [-s stimulus] [-t seconds] [-n name] [-o results.tsv] firmware.elf`
+ *
+ *  Stimulus script format (one event per line, `#` starts a comment):
+ *
+ *      <time ms> pin <port><bit> <level>       e.g. `0 pin D2 1`
+ *      <time ms> adc <channel> <millivolts>    e.g. `5500 adc 0 5000`
+ */
+
+#include <algorithm>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+
+#include "avr_adc.h"
+#include "avr_ioport.h"
+#include "sim_avr.h"
+#include "sim_elf.h"
+#include "sim_io.h"
+
+namespace {
+constexpr uint32_t CPU_FREQUENCY = 16000000;
+constexpr uint32_t DEFAULT_VCC_MV = 5000;
+constexpr avr_io_addr_t GPIOR0_ADDR = 0x3E; /* Data space address (I/O address 0x1E) */
+
+struct StimulusEvent {
+    avr_cycle_count_t cycle;
+    bool isAdc;
+    char port;
+    uint8_t index; /* Pin of `port`, or ADC channel */
+    uint32_t value;
+};
+
+struct LoopTrace {
+    avr_cycle_count_t firstMark;
+    avr_cycle_count_t previousMark;
+    avr_cycle_count_t slept; /* Since the previous mark */
+    avr_cycle_count_t totalSlept; /* Since the first mark */
+    bool started;
+    std::vector<uint32_t> iterations;
+};
+
+/* simavr's sleep callback takes no parameter */
+LoopTrace* sleepTrace;
+
+/*
+ *  simavr skips `1 + howLong` cycles right after calling it. Its default callback sleeps that
+ *  long in real time, which would only slow the run down: it isn't called.
+ */
+void onSleep(avr_t*, avr_cycle_count_t howLong)
+{
+    if (sleepTrace->started)
+        sleepTrace->slept += 1 + howLong;
+}
+
+void onMark(avr_t* avr, avr_io_addr_t addr, uint8_t value, void* param)
+{
+    auto& trace = *static_cast<LoopTrace*>(param);
+
+    avr->data[addr] = value;
+    if (trace.started)
+        trace.iterations.push_back(uint32_t(avr->cycle - trace.previousMark - trace.slept));
+    else
+        trace.firstMark = avr->cycle;
+    trace.totalSlept += trace.slept;
+    trace.slept = 0;
+    trace.previousMark = avr->cycle;
+    trace.started = true;
+}
+
+bool readStimulus(const char* path, std::vector<StimulusEvent>& events)
+{
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        perror(path);
+        return false;
+    }
+
+    char line[128];
+    unsigned lineNumber = 0;
+    while (fgets(line, sizeof(line), file)) {
+        ++lineNumber;
+        if (char* comment = strchr(line, '#'))
+            *comment = '\0';
+
+        unsigned long ms, value;
+        char kind[4], target[4];
+        const int fields = sscanf(line, "%lu %3s %3s %lu", &ms, kind, target, &value);
+        if (fields <= 0)
+            continue;
+
+        StimulusEvent event = {};
+        event.cycle = avr_cycle_count_t(ms) * (CPU_FREQUENCY / 1000);
+        event.value = uint32_t(value);
+        if (fields == 4 && !strcmp(kind, "pin") && target[0] >= 'B' && target[0] <= 'D') {
+            event.port = target[0];
+            event.index = uint8_t(atoi(&target[1]));
+        } else if (fields == 4 && !strcmp(kind, "adc")) {
+            event.isAdc = true;
+            event.index = uint8_t(atoi(target));
+        } else {
+            fprintf(stderr, "%s:%u: malformed stimulus\n", path, lineNumber);
+            fclose(file);
+            return false;
+        }
+
+        events.push_back(event);
+    }
+
+    fclose(file);
+    std::stable_sort(events.begin(), events.end(),
+        [](const StimulusEvent& a, const StimulusEvent& b) { return a.cycle < b.cycle; });
+    return true;
+}
+
+void applyStimulus(avr_t* avr, const StimulusEvent& event)
+{
+    avr_irq_t* irq = event.isAdc
+        ? avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, ADC_IRQ_ADC0 + event.index)
+        : avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(event.port), event.index);
+    if (irq)
+        avr_raise_irq(irq, event.value);
+}
+
+uint32_t percentile(const std::vector<uint32_t>& sorted, const unsigned p)
+{
+    const auto rank = (sorted.size() * p + 99) / 100;
+    return sorted[rank ? rank - 1 : 0];
+}
+}
+
+int main(int argc, char** argv)
+{
+    const char* stimulusPath = nullptr;
+    const char* resultsPath = nullptr;
+    const char* name = nullptr;
+    double seconds = 10.0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "s:t:n:o:")) != -1) {
+        switch (opt) {
+        case 's':
+            stimulusPath = optarg;
+            break;
+        case 't':
+            seconds = atof(optarg);
+            break;
+        case 'n':
+            name = optarg;
+            break;
+        case 'o':
+            resultsPath = optarg;
+            break;
+        default:
+            optind = argc;
+            break;
+        }
+    }
+    if (optind != argc - 1 || seconds <= 0.0) {
+        fprintf(stderr,
+            "usage: %s [-s stimulus] [-t seconds] [-n name] [-o results.tsv] firmware.elf\n",
+            argv[0]);
+        return 1;
+    }
+    const char* firmwarePath = argv[optind];
+    if (!name)
+        name = firmwarePath;
+
+    std::vector<StimulusEvent> events;
+    if (stimulusPath && !readStimulus(stimulusPath, events))
+        return 1;
+
+    elf_firmware_t firmware;
+    memset(&firmware, 0, sizeof(firmware));
+    if (elf_read_firmware(firmwarePath, &firmware)) {
+        fprintf(stderr, "%s: unable to load firmware\n", firmwarePath);
+        return 1;
+    }
+
+    avr_t* avr = avr_make_mcu_by_name("atmega328p");
+    if (!avr) {
+        fprintf(stderr, "simavr: no support for the atmega328p\n");
+        return 1;
+    }
+    avr_init(avr);
+    avr_load_firmware(avr, &firmware);
+    avr->frequency = CPU_FREQUENCY;
+    avr->log = LOG_NONE;
+    if (!avr->vcc)
+        avr->vcc = DEFAULT_VCC_MV;
+    if (!avr->avcc)
+        avr->avcc = DEFAULT_VCC_MV;
+    if (!avr->aref)
+        avr->aref = DEFAULT_VCC_MV;
+
+    LoopTrace trace = {};
+    avr_register_io_write(avr, GPIOR0_ADDR, onMark, &trace);
+    sleepTrace = &trace;
+    avr->sleep = onSleep;
+
+    const auto endCycle = avr_cycle_count_t(seconds * CPU_FREQUENCY);
+    size_t nextEvent = 0;
+    int state = cpu_Running;
+    while (avr->cycle < endCycle && state != cpu_Done && state != cpu_Crashed) {
+        while (nextEvent < events.size() && events[nextEvent].cycle <= avr->cycle)
+            applyStimulus(avr, events[nextEvent++]);
+        state = avr_run(avr);
+    }
+
+    if (state == cpu_Crashed) {
+        fprintf(stderr, "%s: the simulated CPU crashed at PC 0x%04x\n", name, avr->pc);
+        return 1;
+    }
+    if (trace.iterations.empty()) {
+        fprintf(stderr, "%s: no complete loop() iteration (is Bench::markLoop() called?)\n",
+            name);
+        return 1;
+    }
+
+    auto sorted = trace.iterations;
+    std::sort(sorted.begin(), sorted.end());
+
+    FILE* results = resultsPath ? fopen(resultsPath, "a") : stdout;
+    if (!results) {
+        perror(resultsPath);
+        return 1;
+    }
+    /* Up to the last mark, so that a trailing sleep doesn't count */
+    const auto elapsed = trace.previousMark - trace.firstMark;
+    const auto awakePercent
+        = elapsed ? 100.0 * double(elapsed - trace.totalSlept) / double(elapsed) : 0.0;
+    fprintf(results, "%s\t%zu\t%u\t%u\t%u\t%u\t%.2f\n", name, sorted.size(),
+        sorted.front(), percentile(sorted, 50), percentile(sorted, 99), sorted.back(),
+        awakePercent);
+    if (results != stdout)
+        fclose(results);
+
+    return 0;
+}
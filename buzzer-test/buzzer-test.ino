@@ -2,18 +2,31 @@
  *  Simple method for playing note sequences on a buzzer.
  */
 
+#include "common/bench.h"
 #include "common/music.h"
+#include <avr/sleep.h>
 
-static MelodyPlayer mc(CONTRAPUNCTUS_1, 10000);
+static MelodyPlayer mc(MELODY(CONTRAPUNCTUS_1, 10000));
 
-void setup() { pinMode(3, OUTPUT); }
+ISR(TIMER0_COMPA_vect) { mc.tick(); }
 
-void loop() { mc.play(3); }
+void setup() { mc.begin(3); }
+
+/* The melody plays from interrupts, which wake the CPU up */
+void loop()
+{
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sleep_enable();
+    sleep_cpu();
+    sleep_disable();
+}
 
 int main()
 {
     init();
     setup();
-    for (;;)
+    for (;;) {
+        Bench::markLoop();
         loop();
+    }
 }
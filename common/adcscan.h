@@ -0,0 +1,96 @@
+/*
+ *  Background sampling of analog pins: the ADC interrupt converts the pins in turn, without
+ *  end, and publishes the average of every `NUM_SAMPLES` conversions of each of them.
+ *
+ *      using Axes = AdcScan<8, A0, A1>;
+ *      ISR(ADC_vect) { Axes::drain(); }
+ *
+ *      Axes::begin();
+ *      u16 values[Axes::NUM_PINS];
+ *      Axes::latest(values);                   the last published set, pins in order
+ *
+ *  `analogRead()` waits for a whole conversion (13 ADC clocks at 125 kHz, 104 us); here the
+ *  sketch only copies a set out of a double buffer. With 2 pins and 8 samples, a set is
+ *  published every 1.7 ms.
+ *
+ *  Each conversion is started from the interrupt of the previous one rather than by the ADC's
+ *  free-running mode, where the channel switch would only apply to the conversion after the
+ *  next. Claims the ADC, so `analogRead()` can't be used alongside.
+ */
+
+#pragma once
+#include <Arduino.h>
+
+template <u8 NUM_SAMPLES, u8... PINS> class AdcScan {
+public:
+    static constexpr u8 NUM_PINS = sizeof...(PINS);
+    static_assert(NUM_SAMPLES >= 1 && NUM_SAMPLES <= 64, "the sums must fit 16 bits");
+
+    static void begin()
+    {
+        ADMUX = admux(0);
+        ADCSRB = 0;
+
+        /* clk/128: a 125 kHz ADC clock, the fastest with the full 10-bit accuracy */
+        ADCSRA = (1 << ADEN) | (1 << ADSC) | (1 << ADIE) | (1 << ADPS2) | (1 << ADPS1)
+            | (1 << ADPS0);
+    }
+
+    /*
+     *  Publishing switches the buffers, so a copy is consistent unless it takes longer than a
+     *  whole round of conversions.
+     */
+    static void latest(u16 (&values)[NUM_PINS])
+    {
+        const auto& set = sets[frontSet];
+        for (u8 i = 0; i < NUM_PINS; ++i)
+            values[i] = set[i];
+    }
+
+    /* Takes the result and starts the next conversion. Runs in the ADC interrupt. */
+    static void drain()
+    {
+        sums[pin] = u16(sums[pin] + ADC);
+        if (++pin == NUM_PINS) {
+            pin = 0;
+            if (++sample == NUM_SAMPLES) {
+                sample = 0;
+                publish();
+            }
+        }
+
+        ADMUX = admux(pin);
+        ADCSRA |= (1 << ADSC);
+    }
+
+private:
+    static constexpr u8 CHANNELS[NUM_PINS] = { u8(PINS - A0)... };
+
+    /* AVcc reference */
+    static u8 admux(const u8 index) { return u8((1 << REFS0) | CHANNELS[index]); }
+
+    static void publish()
+    {
+        const u8 backSet = !frontSet;
+        for (u8 i = 0; i < NUM_PINS; ++i) {
+            sets[backSet][i] = u16(sums[i] / NUM_SAMPLES);
+            sums[i] = 0;
+        }
+        frontSet = backSet;
+    }
+
+    static volatile u16 sets[2][NUM_PINS];
+    static volatile u8 frontSet;
+    static u16 sums[NUM_PINS];
+    static u8 pin;
+    static u8 sample;
+};
+
+template <u8 NUM_SAMPLES, u8... PINS>
+constexpr u8 AdcScan<NUM_SAMPLES, PINS...>::CHANNELS[NUM_PINS];
+template <u8 NUM_SAMPLES, u8... PINS>
+volatile u16 AdcScan<NUM_SAMPLES, PINS...>::sets[2][NUM_PINS];
+template <u8 NUM_SAMPLES, u8... PINS> volatile u8 AdcScan<NUM_SAMPLES, PINS...>::frontSet;
+template <u8 NUM_SAMPLES, u8... PINS> u16 AdcScan<NUM_SAMPLES, PINS...>::sums[NUM_PINS];
+template <u8 NUM_SAMPLES, u8... PINS> u8 AdcScan<NUM_SAMPLES, PINS...>::pin;
+template <u8 NUM_SAMPLES, u8... PINS> u8 AdcScan<NUM_SAMPLES, PINS...>::sample;
@@ -0,0 +1,19 @@
+/*
+ *  Loop boundary marker for the simavr benchmark harness (see `bench/`).
+ *
+ *  The marker is a write to GPIOR0, a general purpose I/O register that has no side effects
+ *  on the chip, so it compiles to a single 1-cycle `out` instruction and can stay in the
+ *  firmware that gets flashed. The harness timestamps every write to it.
+ */
+
+#pragma once
+#include <Arduino.h>
+
+namespace Bench {
+inline void markLoop()
+{
+#ifndef HOST_SIM
+    GPIOR0 = 0;
+#endif
+}
+}
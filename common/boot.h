@@ -0,0 +1,51 @@
+/*
+ *  Boot time: from reset to the end of `setup()`, when the sketch starts taking input, and to
+ *  the first input it acted on.
+ *
+ *      void setup() { ...; Boot::ready(); }
+ *      Boot::inputAccepted();              where input is acted on, only the first call counts
+ *
+ *  Send `b` over the console (see `console.h`) to print them, in us (0 if not yet). Times are
+ *  taken with `micros()`, which starts counting in the core's `init()`: the bootloader and the
+ *  C runtime's startup aren't included.
+ *
+ *  Built only with `make INSTRUMENTATION="BOOT"`, otherwise the calls are empty.
+ */
+
+#pragma once
+#include <Arduino.h>
+
+#ifdef INSTRUMENT_BOOT
+namespace Boot {
+/* Timestamps, shared by all translation units */
+template <typename = void> struct Stats {
+    static u32 readyUs;
+    static u32 firstInputUs;
+};
+template <typename T> u32 Stats<T>::readyUs;
+template <typename T> u32 Stats<T>::firstInputUs;
+
+inline void ready() { Stats<>::readyUs = micros(); }
+
+inline void inputAccepted()
+{
+    if (!Stats<>::firstInputUs)
+        Stats<>::firstInputUs = micros();
+}
+
+inline void report()
+{
+    Serial.println(F("# boot"));
+    Serial.print(F("ready_us "));
+    Serial.println(Stats<>::readyUs);
+    Serial.print(F("first_input_us "));
+    Serial.println(Stats<>::firstInputUs);
+    Serial.println(F("# end"));
+}
+}
+#else
+namespace Boot {
+inline void ready() { }
+inline void inputAccepted() { }
+}
+#endif
@@ -0,0 +1,113 @@
+/*
+ *  Push button to ground on an external interrupt pin (2 or 3), timed from its interrupt:
+ *  every edge is timestamped with `micros()` as it happens, and the finished presses wait in
+ *  a queue until the sketch takes them.
+ *
+ *      using Button = ::Button<2>;
+ *      ISR(INT0_vect) { Button::capture(); }
+ *
+ *      Button::begin();
+ *      u32 durationUs;
+ *      if (Button::nextPress(durationUs))      a press was released since the last call
+ *
+ *  Polling the pin from `loop()` times a press to within an iteration and misses one that
+ *  doesn't span an iteration. Here neither depends on how long the sketch takes.
+ *
+ *  Contacts bounce, so an edge that comes less than `DEBOUNCE_US` after the previous one
+ *  belongs to the same burst. A burst counts once the level has held for `DEBOUNCE_US`, from
+ *  its first edge, and only if it changed the level. That is seen on the next edge or call to
+ *  `nextPress()`, whichever comes first.
+ */
+
+#pragma once
+#include "fastpin.h"
+#include <Arduino.h>
+
+template <u8 PIN> class Button {
+public:
+    static_assert(PIN == 2 || PIN == 3, "INT0 is on pin 2 and INT1 on pin 3");
+
+    static constexpr u32 DEBOUNCE_US = 5000;
+
+    static void begin()
+    {
+        pinMode(PIN, INPUT_PULLUP);
+        level = stableLevel = FastPin::Pin<PIN>::read();
+        lastEdgeUs = micros() - DEBOUNCE_US; /* So the first edge starts a burst */
+
+        /* Interrupt on any logical change */
+        EICRA = u8((EICRA & ~(0x03 << 2 * INDEX)) | ((1 << ISC00) << 2 * INDEX));
+        EIFR = u8(1 << (INTF0 + INDEX));
+        EIMSK |= u8(1 << (INT0 + INDEX));
+    }
+
+    /* Takes the oldest press that hasn't been taken yet, if any */
+    static bool nextPress(u32& durationUs)
+    {
+        const u8 sreg = SREG;
+        cli();
+        if (level != stableLevel)
+            settle(micros());
+        const bool any = tail != head;
+        if (any) {
+            durationUs = presses[tail];
+            tail = u8((tail + 1) % QUEUE_SIZE);
+        }
+        SREG = sreg;
+        return any;
+    }
+
+    /* Runs in the INT0/INT1 interrupt */
+    static void capture()
+    {
+        const auto now = micros();
+        settle(now);
+
+        if (now - lastEdgeUs >= DEBOUNCE_US)
+            burstStartUs = now;
+        lastEdgeUs = now;
+        level = FastPin::Pin<PIN>::read();
+    }
+
+private:
+    static constexpr u8 INDEX = PIN - 2;
+    static constexpr u8 QUEUE_SIZE = 4;
+
+    /* Commits the last burst if it's over. Runs with interrupts off. */
+    static void settle(const u32 now)
+    {
+        if (level == stableLevel || now - lastEdgeUs < DEBOUNCE_US)
+            return;
+
+        stableLevel = level;
+        if (!level) {
+            pressedAtUs = burstStartUs;
+            return;
+        }
+
+        /* Released. When the queue is full, the press is dropped. */
+        const auto next = u8((head + 1) % QUEUE_SIZE);
+        if (next != tail) {
+            presses[head] = burstStartUs - pressedAtUs;
+            head = next;
+        }
+    }
+
+    static bool level; /* After the last edge */
+    static bool stableLevel; /* After the last burst that counted */
+    static u32 lastEdgeUs;
+    static u32 burstStartUs;
+    static u32 pressedAtUs;
+    static u32 presses[QUEUE_SIZE]; /* Durations, in us */
+    static u8 head;
+    static u8 tail;
+};
+
+template <u8 PIN> bool Button<PIN>::level;
+template <u8 PIN> bool Button<PIN>::stableLevel;
+template <u8 PIN> u32 Button<PIN>::lastEdgeUs;
+template <u8 PIN> u32 Button<PIN>::burstStartUs;
+template <u8 PIN> u32 Button<PIN>::pressedAtUs;
+template <u8 PIN> u32 Button<PIN>::presses[QUEUE_SIZE];
+template <u8 PIN> u8 Button<PIN>::head;
+template <u8 PIN> u8 Button<PIN>::tail;
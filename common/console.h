@@ -0,0 +1,125 @@
+/*
+ *  Serial console of the optional instrumentation (see `INSTRUMENTATION` in the Makefile).
+ *
+ *  Commands (one character each):
+ *      p   dump the profiler's histogram   (PROFILER)
+ *      r   reset the profiler's histogram  (PROFILER)
+ *      z   print the zone timers           (ZONES)
+ *      Z   reset the zone timers           (ZONES)
+ *      m   print the SRAM usage            (MEMORY)
+ *      l   print the loop latency          (LATENCY)
+ *      L   reset the loop latency          (LATENCY)
+ *      t   print the task statistics       (TASKS)
+ *      T   reset the task statistics       (TASKS)
+ *      b   print the boot time             (BOOT)
+ *      a   print the synthesizer's load    (SYNTH)
+ *      A   reset the synthesizer's load    (SYNTH)
+ *
+ *  With `LOG`, the buffered log records are sent between commands (see `log.h`).
+ *
+ *  Without any instrumentation the console compiles to nothing and `Serial` isn't linked in.
+ *  Must be included from the sketch's main file only.
+ */
+
+#pragma once
+#include "boot.h"
+#include "latency.h"
+#include "log.h"
+#include "memory.h"
+#include "profiler.h"
+#include "scheduler.h"
+#include "zones.h"
+
+#ifdef INSTRUMENT_SYNTH
+#include "synth.h"
+#endif
+
+#if defined(INSTRUMENT_PROFILER) || defined(INSTRUMENT_ZONES) || defined(INSTRUMENT_LOG)      \
+    || defined(INSTRUMENT_MEMORY) || defined(INSTRUMENT_LATENCY) || defined(INSTRUMENT_TRACE) \
+    || defined(INSTRUMENT_TASKS) || defined(INSTRUMENT_BOOT) || defined(INSTRUMENT_SYNTH)
+#define CONSOLE_ENABLED
+#endif
+
+namespace Console {
+static constexpr unsigned long BAUDRATE = 9600; /* `MONITOR_BAUDRATE` in the Makefile */
+
+inline void begin()
+{
+#ifdef CONSOLE_ENABLED
+    Serial.begin(BAUDRATE);
+#endif
+#ifdef INSTRUMENT_PROFILER
+    Profiler::begin();
+#endif
+#ifdef INSTRUMENT_ZONES
+    Zones::begin();
+#endif
+}
+
+/* Handles a pending command, if any. Call it once per iteration of the main loop. */
+inline void poll()
+{
+#ifdef INSTRUMENT_LOG
+    Log::drain();
+#endif
+#ifdef CONSOLE_ENABLED
+    if (!Serial.available())
+        return;
+
+    switch (Serial.read()) {
+#ifdef INSTRUMENT_PROFILER
+    case 'p':
+        Profiler::dump();
+        break;
+    case 'r':
+        Profiler::reset();
+        break;
+#endif
+#ifdef INSTRUMENT_ZONES
+    case 'z':
+        Zones::report();
+        break;
+    case 'Z':
+        Zones::reset();
+        break;
+#endif
+#ifdef INSTRUMENT_MEMORY
+    case 'm':
+        Memory::report();
+        break;
+#endif
+#ifdef INSTRUMENT_LATENCY
+    case 'l':
+        Latency::report();
+        break;
+    case 'L':
+        Latency::reset();
+        break;
+#endif
+#ifdef INSTRUMENT_TASKS
+    case 't':
+        Scheduler::report();
+        break;
+    case 'T':
+        Scheduler::reset();
+        break;
+#endif
+#ifdef INSTRUMENT_BOOT
+    case 'b':
+        Boot::report();
+        break;
+#endif
+#ifdef INSTRUMENT_SYNTH
+    case 'a':
+        Dds::report();
+        break;
+    case 'A':
+        Dds::reset();
+        break;
+#endif
+    default:
+        break;
+    }
+#endif
+}
+}
@@ -0,0 +1,67 @@
+/*
+ *  Stackless coroutines, in the style of protothreads: a function that returns at a
+ *  suspension point and, when called again, resumes right after it.
+ *
+ *      Coroutine co;
+ *
+ *      void greet(const u32 currentTs)
+ *      {
+ *          CO_BEGIN(co);
+ *          lcd.print("HELLO");
+ *          CO_SLEEP(co, currentTs, 5000);      returns, and resumes here 5 s later
+ *          lcd.clear();
+ *          CO_END(co);
+ *      }
+ *
+ *      if (!co.sleeping(currentTs))            what's left of a call while it sleeps
+ *          greet(currentTs);
+ *
+ *  The whole state of a coroutine is its `Coroutine`: where to resume and when. Resuming is a
+ *  `switch` on the line of the suspension point, so:
+ *  - locals don't survive a suspension, keep what's needed across one outside the function;
+ *  - a suspension point can't be inside a `switch` of the coroutine's own;
+ *  - the function must return `void`.
+ *
+ *  After `CO_END`, the next call starts over. Zero the `Coroutine` to restart it earlier.
+ */
+
+#pragma once
+#include <Arduino.h>
+
+struct Coroutine {
+    /* Whether it's suspended by `CO_SLEEP` and the wake time hasn't come */
+    bool sleeping(const u32 currentTs) const
+    {
+        return resumeLine && int32_t(currentTs - wakeTs) < 0;
+    }
+
+    u16 resumeLine; /* 0 to start from the beginning */
+    u32 wakeTs;
+};
+
+#define CO_BEGIN(co)                                                                         \
+    switch ((co).resumeLine) {                                                               \
+    case 0:
+
+/* Returns; the next call resumes here */
+#define CO_YIELD(co)                                                                         \
+    do {                                                                                     \
+        (co).resumeLine = __LINE__;                                                          \
+        return;                                                                              \
+    case __LINE__:;                                                                          \
+    } while (0)
+
+/* Returns; the next call made once `ms` milliseconds have passed resumes here */
+#define CO_SLEEP(co, currentTs, ms)                                                          \
+    do {                                                                                     \
+        (co).wakeTs = (currentTs) + (ms);                                                    \
+        (co).resumeLine = __LINE__;                                                          \
+        return;                                                                              \
+    case __LINE__:                                                                           \
+        if ((co).sleeping(currentTs))                                                        \
+            return;                                                                          \
+    } while (0)
+
+#define CO_END(co)                                                                           \
+    }                                                                                        \
+    (co).resumeLine = 0
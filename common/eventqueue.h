@@ -0,0 +1,69 @@
+/*
+ *  Single-producer, single-consumer queue between an interrupt and the main loop, without
+ *  turning interrupts off.
+ *
+ *      EventQueue<Event, 8> events;
+ *
+ *      events.push(event);                 in the interrupt, false (and counted) when full
+ *      while (events.pop(event))           in `loop()`, oldest first
+ *
+ *  Each side writes only its own index, and an index is a single byte, so reading the other
+ *  side's is atomic. An item is written before `head` moves past it and read before `tail`
+ *  does, which a compiler barrier keeps the compiler from reordering. One slot is always left
+ *  empty, to tell a full queue from an empty one.
+ */
+
+#pragma once
+#include <Arduino.h>
+
+template <typename T, u8 SIZE> class EventQueue {
+public:
+    static_assert(SIZE >= 2 && !(SIZE & (SIZE - 1)), "the size must be a power of 2");
+
+    bool push(const T& item)
+    {
+        const u8 index = head;
+        const auto next = u8((index + 1) & INDEX_MASK);
+        if (next == tail) {
+            if (numDropped != DROPPED_MAX)
+                ++numDropped;
+            return false;
+        }
+
+        items[index] = item;
+        asm volatile("" ::: "memory");
+        head = next;
+        return true;
+    }
+
+    bool pop(T& item)
+    {
+        const u8 index = tail;
+        if (index == head)
+            return false;
+
+        item = items[index];
+        asm volatile("" ::: "memory");
+        tail = u8((index + 1) & INDEX_MASK);
+        return true;
+    }
+
+    /* Number of items pushed while the queue was full, saturating at `DROPPED_MAX` */
+    u16 dropped() const
+    {
+        const u8 sreg = SREG;
+        cli();
+        const auto count = numDropped;
+        SREG = sreg;
+        return count;
+    }
+
+private:
+    static constexpr u8 INDEX_MASK = SIZE - 1;
+    static constexpr u16 DROPPED_MAX = 0xFFFF;
+
+    T items[SIZE];
+    volatile u8 head = 0; /* Written by the producer only */
+    volatile u8 tail = 0; /* Written by the consumer only */
+    u16 numDropped = 0; /* Written by the producer only */
+};
@@ -0,0 +1,118 @@
+/*
+ *  Pin I/O resolved at compile time, for the Arduino Uno (ATmega328P).
+ *
+ *      FastPin::Pin<2>::read();                                  instead of `digitalRead(2)`
+ *      FastPin::PinSet<4, 5, 6, 7, 8, 9, 10, 11>::write(bits);  bit `i` goes to the i-th pin
+ *
+ *  `digitalRead()`/`digitalWrite()` look the pin's port and mask up in flash tables and take
+ *  about 50 cycles. Here the pin is a template argument, so a single pin compiles to one
+ *  `sbi`, `cbi` or `in`, and a set of pins to one masked write per port it spans. Unlike
+ *  `digitalWrite()`, nothing turns off the PWM of the pin. Pins must be configured (e.g. with
+ *  `pinMode()` or `Pin<N>::output()`) as usual.
+ */
+
+#pragma once
+#include <Arduino.h>
+
+namespace FastPin {
+enum class Port : u8 {
+    B = 0,
+    C,
+    D,
+};
+
+/* Uno pins 0-7 are PD0-PD7, 8-13 are PB0-PB5 and A0-A5 (14-19) are PC0-PC5 */
+constexpr Port portOf(const u8 pin)
+{
+    return pin < 8 ? Port::D : (pin < 14 ? Port::B : Port::C);
+}
+constexpr u8 maskOf(const u8 pin)
+{
+    return u8(1 << (pin < 8 ? pin : (pin < 14 ? pin - 8 : pin - 14)));
+}
+
+using Register = decltype((PORTB));
+
+inline Register portRegister(const Port port)
+{
+    return port == Port::B ? PORTB : (port == Port::C ? PORTC : PORTD);
+}
+inline Register ddrRegister(const Port port)
+{
+    return port == Port::B ? DDRB : (port == Port::C ? DDRC : DDRD);
+}
+inline Register pinRegister(const Port port)
+{
+    return port == Port::B ? PINB : (port == Port::C ? PINC : PIND);
+}
+
+template <u8 PIN> struct Pin {
+    static_assert(PIN < 20, "not an Arduino Uno pin");
+    static constexpr Port PORT_ID = portOf(PIN);
+    static constexpr u8 MASK = maskOf(PIN);
+
+    static void output() { ddrRegister(PORT_ID) |= MASK; }
+    static void high() { portRegister(PORT_ID) |= MASK; }
+    static void low() { portRegister(PORT_ID) &= u8(~MASK); }
+    static void write(const bool value) { value ? high() : low(); }
+    static bool read() { return pinRegister(PORT_ID) & MASK; }
+};
+
+/* Mask of the pins on `port` */
+constexpr u8 maskOn(Port) { return 0; }
+template <typename... Pins>
+constexpr u8 maskOn(const Port port, const u8 pin, const Pins... pins)
+{
+    return u8((portOf(pin) == port ? maskOf(pin) : 0) | maskOn(port, pins...));
+}
+
+/* Moves bit `index + i` of `bits` to the position of the i-th pin, for the pins on `port` */
+inline u8 spread(Port, u8, u8) { return 0; }
+template <typename... Pins>
+inline u8 spread(
+    const Port port, const u8 bits, const u8 index, const u8 pin, const Pins... pins)
+{
+    const u8 own = portOf(pin) == port && (bits >> index & 1) ? maskOf(pin) : 0;
+    return u8(own | spread(port, bits, u8(index + 1), pins...));
+}
+
+template <u8... PINS> struct PinSet {
+    static_assert(sizeof...(PINS) <= 8, "at most 8 pins per set");
+
+    static void output()
+    {
+        outputOn<Port::B>();
+        outputOn<Port::C>();
+        outputOn<Port::D>();
+    }
+
+    /* Interrupts are held off between the read and the write of each port */
+    static void write(const u8 bits)
+    {
+        const u8 sreg = SREG;
+        cli();
+        writeOn<Port::B>(bits);
+        writeOn<Port::C>(bits);
+        writeOn<Port::D>(bits);
+        SREG = sreg;
+    }
+
+private:
+    template <Port PORT_ID> static void outputOn()
+    {
+        static constexpr u8 MASK = maskOn(PORT_ID, PINS...);
+        if (MASK)
+            ddrRegister(PORT_ID) |= MASK;
+    }
+
+    template <Port PORT_ID> static void writeOn(const u8 bits)
+    {
+        static constexpr u8 MASK = maskOn(PORT_ID, PINS...);
+        if (!MASK)
+            return;
+
+        auto& reg = portRegister(PORT_ID);
+        reg = u8((reg & u8(~MASK)) | spread(PORT_ID, bits, 0, PINS...));
+    }
+};
+}
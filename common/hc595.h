@@ -0,0 +1,23 @@
+/*
+ *  74HC595 shift register on an SPI transport (see `spi.h`). The outputs change on the rising
+ *  edge of `LATCH_PIN`, once the whole byte is in.
+ */
+
+#pragma once
+#include "fastpin.h"
+#include "spi.h"
+
+template <typename Bus, u8 LATCH_PIN> struct Hc595 {
+    static void begin()
+    {
+        Bus::begin();
+        FastPin::Pin<LATCH_PIN>::output();
+    }
+
+    static void write(const u8 value)
+    {
+        FastPin::Pin<LATCH_PIN>::low();
+        Bus::transfer(value);
+        FastPin::Pin<LATCH_PIN>::high();
+    }
+};
@@ -0,0 +1,200 @@
+/*
+ *  HD44780 character LCD in 4-bit mode, written from an interrupt: `write()`, `setCursor()`
+ *  and `clear()` only queue the byte and return, and the Timer1 compare A interrupt sends each
+ *  one as soon as the controller is done with the previous.
+ *
+ *      using Lcd = Hd44780<9, 8, A2, A3, A4, A5>;      RS, E, D4-D7 (R/W tied to ground)
+ *      ISR(TIMER1_COMPA_vect) { Lcd::drain(); }
+ *
+ *      Lcd::begin(2);                                  in `setup()`, returns right away
+ *      Lcd::setCursor(0, 1);
+ *      Lcd::write('A');
+ *
+ *  R/W being grounded, the busy flag can't be read, so the interrupt is scheduled after the
+ *  datasheet's execution time of every instruction, at the slowest oscillator (190 kHz). The
+ *  power-on wait and the initialization sequence (~60 ms) run from the interrupt too, ahead of
+ *  the queue, so the sketch boots and writes meanwhile.
+ *
+ *  Claims Timer1 compare A. Timer1 runs free at clk/8 as for `zones.h`, so the two can be
+ *  built together (and `analogWrite()` on pins 9 and 10 stops working). An interrupt that
+ *  comes late, behind other interrupts, times the next one from when it ran.
+ *  A full queue makes `write()` wait for the interrupt, so don't write from an interrupt or
+ *  with interrupts off.
+ */
+
+#pragma once
+#include "fastpin.h"
+#include <Arduino.h>
+
+template <u8 RS_PIN, u8 ENABLE_PIN, u8 D4_PIN, u8 D5_PIN, u8 D6_PIN, u8 D7_PIN> class Hd44780 {
+public:
+    static void begin(const u8 numRows)
+    {
+        FastPin::Pin<RS_PIN>::output();
+        FastPin::Pin<ENABLE_PIN>::output();
+        DataPins::output();
+        FastPin::Pin<RS_PIN>::low();
+        FastPin::Pin<ENABLE_PIN>::low();
+
+        TCCR1A = 0;
+        TCCR1B = (1 << CS11);
+
+        /* Queuing the first command starts the interrupt, on `STARTUP` */
+        startupStep = 0;
+        command(u8(FUNCTION_SET | (numRows > 1 ? FUNCTION_SET_2_LINES : 0)));
+        command(DISPLAY_CONTROL | DISPLAY_CONTROL_ON);
+        clear();
+        command(ENTRY_MODE_SET | ENTRY_MODE_LEFT);
+    }
+
+    static void clear() { command(CLEAR_DISPLAY); }
+
+    static void setCursor(const u8 col, const u8 row)
+    {
+        command(u8(SET_DDRAM_ADDRESS | (row ? 0x40 : 0x00) | col));
+    }
+
+    static size_t write(const u8 value)
+    {
+        push(value, false);
+        return 1;
+    }
+
+    static void command(const u8 value) { push(value, true); }
+
+    /* Sends the next queued byte. Runs in the Timer1 compare A interrupt. */
+    static void drain()
+    {
+        if (startupStep < NUM_STARTUP_STEPS) {
+            const auto& step = STARTUP[startupStep++];
+            const u8 nibble = pgm_read_byte(&step.nibble);
+            if (nibble != NO_NIBBLE)
+                writeNibble(nibble);
+            schedule(u16(pgm_read_word(&step.delayUs) * TICKS_PER_US));
+            return;
+        }
+
+        const u8 index = tail;
+        if (index == head) {
+            /* The last byte has been executed */
+            TIMSK1 &= u8(~(1 << OCIE1A));
+            return;
+        }
+
+        const auto value = bytes[index];
+        const bool isCommand = commands[index / 8] & (1 << index % 8);
+        tail = u8((index + 1) % QUEUE_SIZE);
+
+        FastPin::Pin<RS_PIN>::write(!isCommand);
+        writeNibble(u8(value >> 4));
+        writeNibble(value);
+
+        const bool isSlow = isCommand && value <= (CLEAR_DISPLAY | RETURN_HOME);
+        schedule(u16((isSlow ? SLOW_EXECUTION_US : EXECUTION_US) * TICKS_PER_US));
+    }
+
+private:
+    using DataPins = FastPin::PinSet<D4_PIN, D5_PIN, D6_PIN, D7_PIN>;
+
+    static constexpr u8 CLEAR_DISPLAY = 0x01;
+    static constexpr u8 RETURN_HOME = 0x02;
+    static constexpr u8 ENTRY_MODE_SET = 0x04;
+    static constexpr u8 ENTRY_MODE_LEFT = 0x02;
+    static constexpr u8 DISPLAY_CONTROL = 0x08;
+    static constexpr u8 DISPLAY_CONTROL_ON = 0x04;
+    static constexpr u8 FUNCTION_SET = 0x20;
+    static constexpr u8 FUNCTION_SET_2_LINES = 0x08;
+    static constexpr u8 SET_DDRAM_ADDRESS = 0x80;
+
+    static constexpr u16 EXECUTION_US = 53;
+    static constexpr u16 SLOW_EXECUTION_US = 2160; /* Clear display and return home */
+    static constexpr u8 TICKS_PER_US = 2;
+    static constexpr u8 START_TICKS = 16; /* From an idle queue to the first interrupt */
+
+    struct StartupStep {
+        u8 nibble;
+        u16 delayUs; /* Until the next step, at most 32767 */
+    };
+    static constexpr u8 NO_NIBBLE = 0xFF;
+    static constexpr u8 NUM_STARTUP_STEPS = 6;
+    static const StartupStep STARTUP[NUM_STARTUP_STEPS]; /* In flash */
+
+    /* Enough for `LcdShadow` to redraw a 16x2 panel without waiting */
+    static constexpr u8 QUEUE_SIZE = 64;
+
+    /* Latched on the falling edge of E, which must stay high for at least 230 ns */
+    static void writeNibble(const u8 nibble)
+    {
+        DataPins::write(nibble);
+        FastPin::Pin<ENABLE_PIN>::high();
+        delayMicroseconds(1);
+        FastPin::Pin<ENABLE_PIN>::low();
+    }
+
+    /*
+     *  Schedules the next interrupt `delayTicks` after what was just written, which the
+     *  controller times the instruction from: after now if the interrupt ran late, and not
+     *  after a compare match already past, which would only match after a wrap of Timer1.
+     */
+    static void schedule(const u16 delayTicks)
+    {
+        const u16 now = TCNT1;
+        const u16 from = int16_t(now - OCR1A) > 0 ? now : OCR1A;
+        OCR1A = u16(from + delayTicks);
+    }
+
+    static void push(const u8 value, const bool isCommand)
+    {
+        const u8 index = head;
+        const auto next = u8((index + 1) % QUEUE_SIZE);
+        while (next == tail)
+            delayMicroseconds(1); /* Full */
+
+        bytes[index] = value;
+        const auto mask = u8(1 << index % 8);
+        auto& flags = commands[index / 8];
+        flags = isCommand ? u8(flags | mask) : u8(flags & ~mask);
+        /* The byte and its flag are stored before `drain()` can see them */
+        asm volatile("" ::: "memory");
+        head = next;
+
+        /* Idle: the controller is ready, start draining */
+        const u8 sreg = SREG;
+        cli();
+        if (!(TIMSK1 & (1 << OCIE1A))) {
+            OCR1A = u16(TCNT1 + START_TICKS);
+            /* Set by every match since the queue went idle, it would run `drain()` at once */
+            TIFR1 = (1 << OCF1A);
+            TIMSK1 |= (1 << OCIE1A);
+        }
+        SREG = sreg;
+    }
+
+    static u8 bytes[QUEUE_SIZE];
+    static u8 commands[QUEUE_SIZE / 8]; /* Bit `i % 8` of `commands[i / 8]`: RS low */
+    static volatile u8 head; /* Written by `push()` */
+    static volatile u8 tail; /* Written by `drain()` */
+    static u8 startupStep; /* Next step of `STARTUP` for `drain()` to run */
+};
+
+/* Power on, then the 4-bit initialization sequence of figure 24 of the datasheet */
+template <u8 RS, u8 E, u8 D4, u8 D5, u8 D6, u8 D7>
+const typename Hd44780<RS, E, D4, D5, D6, D7>::StartupStep
+    Hd44780<RS, E, D4, D5, D6, D7>::STARTUP[NUM_STARTUP_STEPS] PROGMEM = {
+        { NO_NIBBLE, 25000 },
+        { NO_NIBBLE, 25000 },
+        { 0x03, 4500 },
+        { 0x03, 4500 },
+        { 0x03, 150 },
+        { 0x02, EXECUTION_US },
+    };
+template <u8 RS, u8 E, u8 D4, u8 D5, u8 D6, u8 D7>
+u8 Hd44780<RS, E, D4, D5, D6, D7>::bytes[QUEUE_SIZE];
+template <u8 RS, u8 E, u8 D4, u8 D5, u8 D6, u8 D7>
+u8 Hd44780<RS, E, D4, D5, D6, D7>::commands[QUEUE_SIZE / 8];
+template <u8 RS, u8 E, u8 D4, u8 D5, u8 D6, u8 D7>
+volatile u8 Hd44780<RS, E, D4, D5, D6, D7>::head;
+template <u8 RS, u8 E, u8 D4, u8 D5, u8 D6, u8 D7>
+volatile u8 Hd44780<RS, E, D4, D5, D6, D7>::tail;
+template <u8 RS, u8 E, u8 D4, u8 D5, u8 D6, u8 D7>
+u8 Hd44780<RS, E, D4, D5, D6, D7>::startupStep;
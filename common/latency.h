@@ -0,0 +1,172 @@
+/*
+ *  Main loop latency: a histogram of iteration durations with power-of-2 buckets, and a
+ *  deadline whose misses are attributed to a tag (e.g. the active state's update function).
+ *
+ *      void loop()
+ *      {
+ *          const Latency::Scope scope(Latency::Tag(state.updateFunc));
+ *          ...
+ *      }
+ *
+ *  Call `Latency::begin(deadlineUs)` from `setup()`. Send `l` over the console (see
+ *  `console.h`) to print the statistics, `L` to reset them. Tags are printed as flash byte
+ *  addresses, for `avr-addr2line -f -C -e bin/<sketch>.elf <address>`.
+ *
+ *  Built only with `make INSTRUMENTATION="LATENCY"`, otherwise scopes are empty. Times are
+ *  taken with `micros()`, so they have a resolution of 4 us.
+ */
+
+#pragma once
+#include <Arduino.h>
+
+namespace Latency {
+using Tag = void (*)();
+}
+
+#ifdef INSTRUMENT_LATENCY
+namespace Latency {
+/*
+ *  Bucket 0 counts durations of 0 us, bucket `i` durations in [2^(i-1), 2^i) us and the last
+ *  one everything from 65.5 ms up.
+ */
+static constexpr u8 NUM_BUCKETS = 18;
+static constexpr u8 NUM_TAGS = 8;
+
+/* Code addresses are in words on the AVR */
+#ifdef HOST_SIM
+static constexpr u8 CODE_ADDRESS_SCALE = 1;
+#else
+static constexpr u8 CODE_ADDRESS_SCALE = 2;
+#endif
+
+struct Miss {
+    Tag tag;
+    u16 count;
+    u32 worstUs;
+};
+
+/* Statistics, shared by all translation units */
+template <typename = void> struct Stats {
+    static u32 deadlineUs;
+    static u32 maxUs;
+    static u32 buckets[NUM_BUCKETS];
+    static Miss misses[NUM_TAGS];
+    static u16 untrackedMisses; /* Misses of tags that didn't fit in `misses` */
+};
+template <typename T> u32 Stats<T>::deadlineUs;
+template <typename T> u32 Stats<T>::maxUs;
+template <typename T> u32 Stats<T>::buckets[NUM_BUCKETS];
+template <typename T> Miss Stats<T>::misses[NUM_TAGS];
+template <typename T> u16 Stats<T>::untrackedMisses;
+
+inline u8 bucketOf(u32 us)
+{
+    u8 bucket = 0;
+    while (us && bucket < NUM_BUCKETS - 1) {
+        us >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+inline void recordMiss(const u32 us, const Tag tag)
+{
+    for (auto& miss : Stats<>::misses) {
+        if (miss.count && miss.tag != tag)
+            continue;
+
+        miss.tag = tag;
+        if (miss.count != 0xFFFF)
+            ++miss.count;
+        if (us > miss.worstUs)
+            miss.worstUs = us;
+        return;
+    }
+
+    if (Stats<>::untrackedMisses != 0xFFFF)
+        ++Stats<>::untrackedMisses;
+}
+
+inline void record(const u32 us, const Tag tag)
+{
+    ++Stats<>::buckets[bucketOf(us)];
+    if (us > Stats<>::maxUs)
+        Stats<>::maxUs = us;
+    if (us > Stats<>::deadlineUs)
+        recordMiss(us, tag);
+}
+
+inline void reset()
+{
+    Stats<>::maxUs = 0;
+    memset(Stats<>::buckets, 0, sizeof(Stats<>::buckets));
+    memset(Stats<>::misses, 0, sizeof(Stats<>::misses));
+    Stats<>::untrackedMisses = 0;
+}
+
+inline void begin(const u32 deadlineUs)
+{
+    Stats<>::deadlineUs = deadlineUs;
+    reset();
+}
+
+class Scope {
+public:
+    explicit Scope(const Tag tag)
+        : tag(tag)
+        , start(micros())
+    {
+    }
+    ~Scope() { record(micros() - start, tag); }
+
+private:
+    Tag tag;
+    u32 start;
+};
+
+/* The histogram (lower bound of each bucket and its count), then the misses of each tag */
+inline void report()
+{
+    Serial.println(F("# latency"));
+    Serial.print(F("deadline_us "));
+    Serial.println(Stats<>::deadlineUs);
+    Serial.print(F("max_us "));
+    Serial.println(Stats<>::maxUs);
+    Serial.println(F("from_us\tcount"));
+    for (u8 i = 0; i < NUM_BUCKETS; ++i) {
+        if (!Stats<>::buckets[i])
+            continue;
+        Serial.print(i ? 1UL << (i - 1) : 0UL);
+        Serial.print('\t');
+        Serial.println(Stats<>::buckets[i]);
+    }
+
+    Serial.println(F("tag\tmisses\tworst_us"));
+    for (const auto& miss : Stats<>::misses) {
+        if (!miss.count)
+            continue;
+        const auto address = static_cast<unsigned long>(reinterpret_cast<uintptr_t>(miss.tag));
+        Serial.print(F("0x"));
+        Serial.print(address * CODE_ADDRESS_SCALE, HEX);
+        Serial.print('\t');
+        Serial.print(miss.count);
+        Serial.print('\t');
+        Serial.println(miss.worstUs);
+    }
+    if (Stats<>::untrackedMisses) {
+        Serial.print(F("other\t"));
+        Serial.println(Stats<>::untrackedMisses);
+    }
+    Serial.println(F("# end"));
+}
+}
+#else
+namespace Latency {
+inline void begin(u32) { }
+
+class Scope {
+public:
+    explicit Scope(Tag) { }
+};
+}
+#endif
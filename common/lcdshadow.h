@@ -0,0 +1,78 @@
+/*
+ *  Shadow buffer for a character LCD: printing goes to RAM and `commit()` sends the panel only
+ *  the cells that differ from what it shows.
+ *
+ *      LcdShadow<LiquidCrystal, 16, 2> lcd(panel);
+ *
+ *      lcd.clear();             no bus traffic, unlike `LiquidCrystal::clear()` (1.6 ms)
+ *      lcd.print("SCORE: ");
+ *      lcd.print(score);
+ *      lcd.commit();            e.g. only the last digit, if that's all that changed
+ *
+ *  Consecutive changed cells are sent as a run, relying on the HD44780 advancing its cursor
+ *  after every character; the cursor is moved only to skip over unchanged cells. Text past the
+ *  end of a line is dropped, there's no wrapping.
+ */
+
+#pragma once
+#include <Arduino.h>
+
+template <typename Panel, u8 NUM_COLS, u8 NUM_ROWS> class LcdShadow : public Print {
+public:
+    /* The panel must be blank (e.g. right after `begin()`) */
+    explicit LcdShadow(Panel& panel)
+        : panel(panel)
+    {
+        memset(cells, ' ', sizeof(cells));
+        memset(shown, ' ', sizeof(shown));
+    }
+
+    void clear()
+    {
+        memset(cells, ' ', sizeof(cells));
+        setCursor(0, 0);
+    }
+
+    void setCursor(const u8 col, const u8 row)
+    {
+        cursorCol = col;
+        cursorRow = row;
+    }
+
+    size_t write(const u8 value) override
+    {
+        if (cursorCol >= NUM_COLS || cursorRow >= NUM_ROWS)
+            return 0;
+
+        cells[cursorRow][cursorCol++] = char(value);
+        return 1;
+    }
+    using Print::write;
+
+    void commit()
+    {
+        for (u8 row = 0; row < NUM_ROWS; ++row)
+            for (u8 col = 0; col < NUM_COLS; ++col) {
+                if (cells[row][col] == shown[row][col])
+                    continue;
+
+                if (row != panelRow || col != panelCol)
+                    panel.setCursor(col, row);
+                panel.write(u8(cells[row][col]));
+                shown[row][col] = cells[row][col];
+                panelRow = row;
+                panelCol = u8(col + 1);
+            }
+    }
+
+private:
+    static constexpr u8 NO_ROW = 0xFF;
+
+    Panel& panel;
+    char cells[NUM_ROWS][NUM_COLS]; /* What the sketch printed */
+    char shown[NUM_ROWS][NUM_COLS]; /* What the panel shows */
+    u8 cursorCol = 0;
+    u8 cursorRow = 0;
+    u8 panelCol = 0;
+    u8 panelRow = NO_ROW; /* Until the panel's cursor position is known */
+};
@@ -0,0 +1,124 @@
+/*
+ *  Tokenized, deferred logging.
+ *
+ *      LOG("player moved to {i8} {i8}", x, y);
+ *
+ *  The format string never reaches the chip: it's emitted into `.logstr`, a section of the ELF
+ *  that isn't loaded, and its offset in that section is the record's ID. A record is just
+ *  the 16-bit ID followed by the raw (little-endian) bytes of the arguments, appended to a
+ *  ring buffer without blocking. The console (see `console.h`) drains the buffer to the
+ *  serial port between iterations of the main loop, and `tools/log.py` rebuilds the text
+ *  from the ELF.
+ *
+ *  Placeholders give the type of the argument: `{u8}`, `{u16}`, `{u32}`, `{i8}`, `{i16}`,
+ *  `{i32}`, `{x8}`, `{x16}`, `{x32}` (hexadecimal) and `{b}` (bool). Format strings can't
+ *  contain `"`, `\` or `%`. Records are only written from the main loop (not from
+ *  interrupts), so the buffer needs no locking. When the buffer is full the record is dropped
+ *  and the number of dropped records is reported with the next one.
+ *
+ *  Built only with `make INSTRUMENTATION="LOG"`, otherwise `LOG(...)` expands to nothing and
+ *  its arguments aren't evaluated.
+ */
+
+#pragma once
+#include <Arduino.h>
+
+#ifdef INSTRUMENT_LOG
+#ifdef HOST_SIM
+#error "Tokenized logging needs the AVR toolchain"
+#endif
+
+namespace Log {
+static constexpr u8 BUFFER_SIZE = 128; /* Power of 2 */
+static constexpr u8 INDEX_MASK = BUFFER_SIZE - 1;
+static constexpr u16 DROPPED_ID = 0xFFFF;
+
+/* Ring buffer state, shared by all translation units */
+template <typename = void> struct Buffer {
+    static u8 data[BUFFER_SIZE];
+    static volatile u8 head; /* Written by the producer only */
+    static volatile u8 tail; /* Written by the consumer only */
+    static u16 dropped;
+};
+template <typename T> u8 Buffer<T>::data[BUFFER_SIZE];
+template <typename T> volatile u8 Buffer<T>::head;
+template <typename T> volatile u8 Buffer<T>::tail;
+template <typename T> u16 Buffer<T>::dropped;
+
+template <typename... Args> struct PayloadSize;
+template <> struct PayloadSize<> {
+    static constexpr u8 value = 0;
+};
+template <typename T, typename... Args> struct PayloadSize<T, Args...> {
+    static constexpr u8 value = u8(sizeof(T) + PayloadSize<Args...>::value);
+};
+
+inline u8 freeSpace() { return u8(INDEX_MASK - u8(Buffer<>::head - Buffer<>::tail)); }
+
+template <typename T> inline void put(u8& head, const T& value)
+{
+    const auto bytes = reinterpret_cast<const u8*>(&value);
+    for (u8 i = 0; i < sizeof(T); ++i)
+        Buffer<>::data[head++ & INDEX_MASK] = bytes[i];
+}
+
+/* The format string is only there for the macro below, it's never referenced */
+template <typename... Args>
+inline __attribute__((always_inline)) void write(
+    const u16 id, const char*, const Args&... args)
+{
+    static constexpr u8 RECORD_SIZE = sizeof(id) + PayloadSize<Args...>::value;
+    static constexpr u8 DROPPED_RECORD_SIZE = sizeof(DROPPED_ID) + sizeof(u16);
+    static_assert(RECORD_SIZE < BUFFER_SIZE / 2, "log record too large");
+
+    auto& dropped = Buffer<>::dropped;
+    if (freeSpace() < RECORD_SIZE + (dropped ? DROPPED_RECORD_SIZE : 0)) {
+        ++dropped;
+        return;
+    }
+
+    u8 head = Buffer<>::head;
+    if (dropped) {
+        put(head, DROPPED_ID);
+        put(head, dropped);
+        dropped = 0;
+    }
+
+    put(head, id);
+    const int expand[] = { 0, (put(head, args), 0)... };
+    (void)expand;
+
+    /* Publish the record only once it's complete */
+    Buffer<>::head = head;
+}
+
+/* Sends buffered bytes for as long as the serial port can take them without blocking */
+inline void drain()
+{
+    auto tail = Buffer<>::tail;
+    while (tail != Buffer<>::head && Serial.availableForWrite() > 0)
+        Serial.write(Buffer<>::data[tail++ & INDEX_MASK]);
+    Buffer<>::tail = tail;
+}
+}
+
+/*
+ *  Emits the format string into `.logstr` and loads the offset of its label. `.logstr` has no
+ *  `a` flag, so the linker doesn't allocate it in flash or RAM and lays it out from address 0.
+ */
+#define LOG_ID(fmt)                                                                          \
+    []() -> u16 {                                                                            \
+        u16 id;                                                                              \
+        asm(".pushsection .logstr,\"\",@progbits \n\t"                                       \
+            "0: .asciz \"" fmt "\"                \n\t"                                      \
+            ".popsection                          \n\t"                                      \
+            "ldi %A0, lo8(0b)                     \n\t"                                      \
+            "ldi %B0, hi8(0b)                     \n\t"                                      \
+            : "=d"(id));                                                                     \
+        return id;                                                                           \
+    }()
+#define LOG_FORMAT(fmt, ...) fmt
+#define LOG(...) Log::write(LOG_ID(LOG_FORMAT(__VA_ARGS__, "")), __VA_ARGS__)
+#else
+#define LOG(...) ((void)0)
+#endif
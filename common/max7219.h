@@ -0,0 +1,102 @@
+/*
+ *  MAX7219 LED matrix drivers on an SPI transport (see `spi.h`), `NUM_DEVICES` of them
+ *  daisy-chained on the same load line. Device 0 is the one wired to the microcontroller.
+ *
+ *  Mirrors the part of the `LedControl` library that the sketches use, minus the pixel access:
+ *  the chips' registers are write-only, so pixels are drawn into a framebuffer owned by the
+ *  sketch and sent a row at a time.
+ */
+
+#pragma once
+#include "fastpin.h"
+#include "spi.h"
+
+template <typename Bus, u8 LOAD_PIN, u8 NUM_DEVICES = 1> class Max7219 {
+public:
+    static_assert(NUM_DEVICES >= 1 && NUM_DEVICES <= 8, "1 to 8 devices per chain");
+
+    static constexpr u8 NUM_ROWS = 8;
+
+    /* Leaves every device blank and shut down */
+    void begin()
+    {
+        Bus::begin();
+        FastPin::Pin<LOAD_PIN>::output();
+        FastPin::Pin<LOAD_PIN>::high();
+
+        writeAll(OP_DISPLAYTEST, 0);
+        writeAll(OP_SCANLIMIT, NUM_ROWS - 1);
+        writeAll(OP_DECODEMODE, 0);
+        for (u8 row = 0; row < NUM_ROWS; ++row)
+            writeAll(u8(OP_DIGIT0 + row), 0);
+        writeAll(OP_SHUTDOWN, 0);
+    }
+
+    void shutdown(const u8 device, const bool status)
+    {
+        writeRegister(device, OP_SHUTDOWN, !status);
+    }
+
+    /* From 0 to 15, other values are ignored as in `LedControl` */
+    void setIntensity(const u8 device, const u8 intensity)
+    {
+        if (intensity < 16)
+            writeRegister(device, OP_INTENSITY, intensity);
+    }
+
+    void clearDisplay(const u8 device)
+    {
+        for (u8 row = 0; row < NUM_ROWS; ++row)
+            setRow(device, row, 0);
+    }
+
+    /* Column 0 is the most significant bit of `value`, as in `LedControl` */
+    void setRow(const u8 device, const u8 row, const u8 value)
+    {
+        writeRegister(device, u8(OP_DIGIT0 + row), value);
+    }
+
+    /*
+     *  Row `row` of every device, `values[device]` each, latched by a single load pulse: a
+     *  whole chain takes `NUM_ROWS` transfers instead of `NUM_ROWS * NUM_DEVICES`.
+     */
+    void setRows(const u8 row, const u8* const values)
+    {
+        FastPin::Pin<LOAD_PIN>::low();
+        for (u8 i = NUM_DEVICES; i-- > 0;) {
+            Bus::transfer(u8(OP_DIGIT0 + row));
+            Bus::transfer(values[i]);
+        }
+        FastPin::Pin<LOAD_PIN>::high();
+    }
+
+private:
+    static constexpr u8 OP_NOOP = 0;
+    static constexpr u8 OP_DIGIT0 = 1;
+    static constexpr u8 OP_DECODEMODE = 9;
+    static constexpr u8 OP_INTENSITY = 10;
+    static constexpr u8 OP_SCANLIMIT = 11;
+    static constexpr u8 OP_SHUTDOWN = 12;
+    static constexpr u8 OP_DISPLAYTEST = 15;
+
+    /* The farthest device's bytes go first; the others get a no-op */
+    void writeRegister(const u8 device, const u8 opcode, const u8 data)
+    {
+        FastPin::Pin<LOAD_PIN>::low();
+        for (u8 i = NUM_DEVICES; i-- > 0;) {
+            Bus::transfer(i == device ? opcode : u8(OP_NOOP));
+            Bus::transfer(i == device ? data : 0);
+        }
+        FastPin::Pin<LOAD_PIN>::high();
+    }
+
+    void writeAll(const u8 opcode, const u8 data)
+    {
+        FastPin::Pin<LOAD_PIN>::low();
+        for (u8 i = 0; i < NUM_DEVICES; ++i) {
+            Bus::transfer(opcode);
+            Bus::transfer(data);
+        }
+        FastPin::Pin<LOAD_PIN>::high();
+    }
+};
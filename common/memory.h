@@ -0,0 +1,97 @@
+/*
+ *  SRAM usage report.
+ *
+ *  At reset, before the C runtime initializes anything, the memory between the end of `.bss`
+ *  and the top of the stack is painted with a known byte. The deepest the stack has ever
+ *  reached is where the paint stops. Send `m` over the console (see `console.h`) to print:
+ *
+ *      data        size of `.data` (including `static constexpr` tables, copied from flash)
+ *      bss         size of `.bss`
+ *      heap        size of the heap (0 unless `malloc()` was used)
+ *      stack       current stack depth
+ *      stack_max   deepest stack depth since reset
+ *      free        current gap between the heap and the stack
+ *      free_min    smallest gap since reset
+ *
+ *  All sizes are in bytes. A stack frame that happens to store the paint byte right at the
+ *  edge makes `stack_max` lower by a few bytes.
+ *
+ *  Built only with `make INSTRUMENTATION="MEMORY"`. Defines a function in `.init1`, so it must
+ *  be included from the sketch's main file only (normally through `console.h`).
+ */
+
+#pragma once
+#include <Arduino.h>
+
+#ifdef INSTRUMENT_MEMORY
+namespace Memory {
+static constexpr u8 PAINT = 0xC5;
+
+/* From the linker script and `malloc()` */
+extern "C" u8 __data_start;
+extern "C" u8 __data_end;
+extern "C" u8 __bss_start;
+extern "C" u8 __bss_end;
+extern "C" u8 __heap_start;
+extern "C" void* __brkval;
+
+/*
+ *  Runs straight from the reset vector: nothing is on the stack yet and `r1` isn't cleared, so
+ *  it can't be written in C.
+ */
+static void paint() __attribute__((naked, used, section(".init1")));
+void paint()
+{
+    asm volatile("ldi  r30, lo8(__heap_start) \n\t"
+                 "ldi  r31, hi8(__heap_start) \n\t"
+                 "ldi  r24, %[paint]          \n\t"
+                 "ldi  r25, hi8(%[end])       \n\t"
+                 "rjmp 1f                     \n\t"
+                 "0:                          \n\t"
+                 "st   Z+, r24                \n\t"
+                 "1:                          \n\t"
+                 "cpi  r30, lo8(%[end])       \n\t"
+                 "cpc  r31, r25               \n\t"
+                 "brlo 0b                     \n\t"
+                 :
+                 : [paint] "i"(PAINT), [end] "i"(RAMEND + 1));
+}
+
+inline const u8* heapEnd()
+{
+    return __brkval ? static_cast<const u8*>(__brkval) : &__heap_start;
+}
+
+/* First byte above the heap that the stack has ever written */
+inline const u8* stackLowWater()
+{
+    auto p = heapEnd();
+    while (p <= reinterpret_cast<const u8*>(RAMEND) && *p == PAINT)
+        ++p;
+    return p;
+}
+
+inline void printField(const __FlashStringHelper* name, const u16 value)
+{
+    Serial.print(name);
+    Serial.println(value);
+}
+
+inline void report()
+{
+    const auto sp = reinterpret_cast<const u8*>(SP);
+    const auto heap = heapEnd();
+    const auto lowWater = stackLowWater();
+
+    Serial.println(F("# memory"));
+    printField(F("data "), u16(&__data_end - &__data_start));
+    printField(F("bss "), u16(&__bss_end - &__bss_start));
+    printField(F("heap "), u16(heap - &__heap_start));
+    printField(F("stack "), u16(RAMEND - u16(sp)));
+    printField(F("stack_max "), u16(RAMEND + 1 - u16(lowWater)));
+    printField(F("free "), u16(sp + 1 - heap));
+    printField(F("free_min "), u16(lowWater - heap));
+    Serial.println(F("# end"));
+}
+}
+#endif
@@ -1,61 +1,223 @@
+/*
+ *  Melodies compiled into flash and played from interrupts.
+ *
+ *      static MelodyPlayer player(MELODY(LITTLE_FUGUE_IN_G_MINOR, 10000));  10 s per round
+ *      ISR(TIMER0_COMPA_vect) { player.tick(); }
+ *
+ *      player.begin(3);                    in `setup()`, then nothing from `loop()`
+ *
+ *  A melody is written as a `Note` table, each note `slice` long in the melody's own unit.
+ *  `MELODY()` compiles it, at compile time, into a table of `PackedNote` in flash: the Timer2
+ *  settings that make the note's frequency and its duration in ticks. The tempo is the exact
+ *  ratio of the round's duration to its number of slices, each note starting on the tick
+ *  nearest to where it should, so rounding doesn't add up over a round. The `Note` table
+ *  itself is only read by the compiler and takes no memory on the board.
+ *
+ *  The player ticks on the Timer0 compare A interrupt, which comes once per Timer0 period
+ *  (1.024 ms) whatever `OCR0A` holds, so PWM on pin 6 keeps working. Timer2 toggles the buzzer
+ *  by itself, in CTC mode, which puts it on pin 3 (OC2B) or 11 (OC2A) and makes it unusable
+ *  with `tone()` and the profiler. Claims Timer0 compare A too, like hw-4's display.
+ */
+
 #pragma once
 #include "notes.h"
 #include <Arduino.h>
 
+#ifdef INSTRUMENT_PROFILER
+#error "the profiler claims Timer2, which MelodyPlayer plays on"
+#endif
+
 struct Note {
-    unsigned int freq;
+    unsigned int freq; /* 0 for a rest */
     unsigned long slice;
 };
 
-using Melody = const Note*;
+struct PackedNote {
+    u8 compare; /* OCR2A, the buzzer toggles every `compare + 1` Timer2 clocks */
+    u8 clockSelect; /* TCCR2B, 0 for a rest */
+    u16 ticks;
+};
+
+/* Compiled notes, of `PackedNote` or of another player's record (see `Music::compile()`) */
+template <typename RECORD> struct NoteStream {
+    const RECORD* notes; /* In flash */
+    u16 count;
+};
+
+using Melody = NoteStream<PackedNote>;
+
+#define MELODY(notes, totalMs)                                                               \
+    Music::compile<PackedNote, Music::pack, notes, sizeof(notes) / sizeof(notes[0]), totalMs>()
+
+namespace Music {
+static constexpr unsigned long TICK_CYCLES = 64UL * 256; /* Timer0's period */
+
+constexpr unsigned long long sliceSum(const Note* notes, const size_t count)
+{
+    return count ? notes[0].slice + sliceSum(notes + 1, count - 1) : 0;
+}
+
+/* Tick on which note `index` starts, the nearest to its exact time */
+constexpr unsigned long long startTick(
+    const Note* notes, const size_t count, const u32 totalMs, const size_t index)
+{
+    return (2 * sliceSum(notes, index) * totalMs * (F_CPU / 1000)
+               + sliceSum(notes, count) * TICK_CYCLES)
+        / (2 * sliceSum(notes, count) * TICK_CYCLES);
+}
+
+/* Length of note `index` in ticks */
+constexpr u16 ticksOf(
+    const Note* notes, const size_t count, const u32 totalMs, const size_t index)
+{
+    return u16(
+        startTick(notes, count, totalMs, index + 1) - startTick(notes, count, totalMs, index));
+}
+
+/* Of Timer2's clock select values 1 to 7 */
+constexpr unsigned long prescaler(const u8 clockSelect)
+{
+    return clockSelect < 3 ? (clockSelect == 1 ? 1 : 8)
+                           : (clockSelect < 6 ? 32UL << (clockSelect - 3)
+                                              : (clockSelect == 6 ? 256 : 1024));
+}
+
+/* Half a period of `freq`, in Timer2 clocks, rounded */
+constexpr unsigned long halfPeriod(const unsigned freq, const u8 clockSelect)
+{
+    return (F_CPU + prescaler(clockSelect) * freq) / (2 * prescaler(clockSelect) * freq);
+}
+
+/* The fastest Timer2 clock with which half a period of `freq` fits in 8 bits */
+constexpr u8 clockSelectOf(const unsigned freq, const u8 clockSelect = 1)
+{
+    return clockSelect == 7 || halfPeriod(freq, clockSelect) <= 0x100
+        ? clockSelect
+        : clockSelectOf(freq, u8(clockSelect + 1));
+}
+
+constexpr u8 compareOf(const unsigned freq)
+{
+    return u8(halfPeriod(freq, clockSelectOf(freq)) - 1);
+}
+
+constexpr PackedNote pack(
+    const Note* notes, const size_t count, const u32 totalMs, const size_t index)
+{
+    return PackedNote {
+        notes[index].freq ? compareOf(notes[index].freq) : u8(0),
+        notes[index].freq ? clockSelectOf(notes[index].freq) : u8(0),
+        ticksOf(notes, count, totalMs, index),
+    };
+}
+
+template <size_t...> struct Indices { };
+template <size_t N, size_t... I> struct MakeIndices : MakeIndices<N - 1, N - 1, I...> { };
+template <size_t... I> struct MakeIndices<0, I...> {
+    using Type = Indices<I...>;
+};
+
+template <typename RECORD> using Packer = RECORD (*)(const Note*, size_t, u32, size_t);
+
+template <typename RECORD, Packer<RECORD> PACK, const Note* NOTES, size_t COUNT, u32 TOTAL_MS,
+    typename = typename MakeIndices<COUNT>::Type>
+struct Compiled;
+
+template <typename RECORD, Packer<RECORD> PACK, const Note* NOTES, size_t COUNT, u32 TOTAL_MS,
+    size_t... I>
+struct Compiled<RECORD, PACK, NOTES, COUNT, TOTAL_MS, Indices<I...>> {
+    static_assert(COUNT > 0 && COUNT <= 0xFFFF, "a melody has 1 to 65535 notes");
+    static_assert(startTick(NOTES, COUNT, TOTAL_MS, COUNT) > 0, "a round is a tick at least");
+    static_assert(
+        startTick(NOTES, COUNT, TOTAL_MS, COUNT) <= 0xFFFF, "67 s per round at most");
+
+    static const RECORD notes[COUNT];
+};
+
+template <typename RECORD, Packer<RECORD> PACK, const Note* NOTES, size_t COUNT, u32 TOTAL_MS,
+    size_t... I>
+const RECORD
+    Compiled<RECORD, PACK, NOTES, COUNT, TOTAL_MS, Indices<I...>>::notes[COUNT] PROGMEM
+    = { PACK(NOTES, COUNT, TOTAL_MS, I)... };
 
-template <typename T> static unsigned get_total_slices(const T& notes)
+/* Packs each note of `NOTES` into a `RECORD`, in flash */
+template <typename RECORD, Packer<RECORD> PACK, const Note* NOTES, size_t COUNT, u32 TOTAL_MS>
+constexpr NoteStream<RECORD> compile()
 {
-    unsigned sum = 0;
-    for (const auto& note : notes)
-        sum += note.slice;
-    return sum;
+    return { Compiled<RECORD, PACK, NOTES, COUNT, TOTAL_MS>::notes, u16(COUNT) };
+}
 }
 
 class MelodyPlayer {
 public:
-    template <typename T>
-    constexpr MelodyPlayer(const T& notes, unsigned total_duration)
-        : mel(&notes[0])
-        , num_notes(sizeof(notes) / sizeof(notes[0]))
-        , ms_per_slice(total_duration / get_total_slices(notes))
-        , i(num_notes)
-        , past(0)
+    constexpr MelodyPlayer(const Melody melody)
+        : melody(melody)
+        , output(0)
+        , i(0)
+        , ticks(0)
+        , elapsed(0)
     {
     }
 
-    void play(const uint8_t buzzer_pin)
+    /* Starts the melody from its first note, on pin 3 or 11 */
+    void begin(const uint8_t pin)
     {
-        const auto current_ts = millis();
+        stop();
+        pinMode(pin, OUTPUT);
+        digitalWrite(pin, LOW); /* While the output is disconnected, during rests */
+        output = pin == 11 ? (1 << COM2A0) : (1 << COM2B0);
+        OCR2B = 0;
+        i = 0;
+        elapsed = 0;
+        start_note();
+        TIMSK0 |= (1 << OCIE0A);
+    }
 
-        if (i == num_notes) {
-            i = 0;
-            past = current_ts;
-        }
+    void stop()
+    {
+        TIMSK0 &= uint8_t(~(1 << OCIE0A));
+        TCCR2B = 0;
+        TCCR2A = 0;
+    }
 
-        const auto note = mel[i].freq;
-        if (note)
-            tone(buzzer_pin, note);
-        else
-            noTone(buzzer_pin);
+    /* Runs in the Timer0 compare A interrupt */
+    void tick()
+    {
+        if (++elapsed < ticks)
+            return;
 
-        if (current_ts - past > mel[i].slice * ms_per_slice) {
-            past = current_ts;
-            ++i;
-        }
+        /* Notes shorter than half a tick are skipped */
+        elapsed = 0;
+        do {
+            if (++i == melody.count)
+                i = 0;
+            start_note();
+        } while (!ticks);
     }
 
 private:
-    Melody mel;
-    unsigned num_notes;
-    unsigned long ms_per_slice;
-    unsigned i;
-    unsigned long past;
+    void start_note()
+    {
+        const auto& note = melody.notes[i];
+        ticks = pgm_read_word(&note.ticks);
+        const u8 clock_select = pgm_read_byte(&note.clockSelect);
+
+        TCCR2B = 0;
+        if (!clock_select) {
+            TCCR2A = (1 << WGM21);
+            return;
+        }
+        OCR2A = pgm_read_byte(&note.compare);
+        TCNT2 = 0;
+        TCCR2A = uint8_t((1 << WGM21) | output);
+        TCCR2B = clock_select;
+    }
+
+    Melody melody;
+    uint8_t output; /* Its COM2x0 bit */
+    uint16_t i;
+    uint16_t ticks; /* Of note `i` */
+    uint16_t elapsed; /* Since note `i` started */
 };
 
 static constexpr Note LITTLE_FUGUE_IN_G_MINOR[] = {
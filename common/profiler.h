@@ -0,0 +1,123 @@
+/*
+ *  Statistical profiler.
+ *
+ *  A timer interrupt samples the address the CPU was executing when it fired and counts it
+ *  in a histogram of the flash. Send `p` over the console (see `console.h`) to dump the
+ *  histogram (`r` resets it) and map it back to function names with `tools/profile.py`. The
+ *  histogram covers the time since reset: opening the serial port resets the board, so the
+ *  tool waits for the profile to build up before asking for it.
+ *
+ *  Built only with `make INSTRUMENTATION="PROFILER"`. Claims Timer2 (so it can't be used
+ *  together with `tone()`, and `music.h` and `synth.h` don't build with it) and defines its
+ *  interrupt handler, so it must be included from the sketch's main file only (normally
+ *  through `console.h`).
+ */
+
+#pragma once
+#include <Arduino.h>
+
+#ifdef INSTRUMENT_PROFILER
+namespace Profiler {
+static constexpr u8 NUM_BINS = 128;
+
+/*
+ *  Timer2 in CTC mode, clk/256, 61 ticks per sample: ~1024 samples per second. The period is
+ *  deliberately not a multiple of Timer0's overflow (the `millis()` interrupt), so that
+ *  periodic work doesn't alias with the sampling.
+ */
+static constexpr u8 COMPARE_TICKS = 61;
+
+static u16 bins[NUM_BINS];
+static u32 numSamples;
+static u16 numOutside;
+static u8 binShift;
+static volatile u16 sampledPc; /* Word address */
+
+extern "C" char _etext; /* End of `.text`, from the linker script */
+
+inline void reset()
+{
+    TIMSK2 &= u8(~(1 << OCIE2A));
+    memset(bins, 0, sizeof(bins));
+    numSamples = 0;
+    numOutside = 0;
+    TIMSK2 |= (1 << OCIE2A);
+}
+
+inline void begin()
+{
+    /* Smallest bin size (in words) such that the bins cover all of `.text` */
+    const auto textWords = u16(u16(&_etext) / 2);
+    while (u16(textWords - 1) >> binShift >= NUM_BINS)
+        ++binShift;
+
+    TCCR2A = (1 << WGM21);
+    TCCR2B = (1 << CS22) | (1 << CS21);
+    OCR2A = COMPARE_TICKS - 1;
+    TCNT2 = 0;
+    reset();
+}
+
+inline void dump()
+{
+    TIMSK2 &= u8(~(1 << OCIE2A));
+
+    Serial.println(F("# profile"));
+    Serial.print(F("shift "));
+    Serial.println(binShift);
+    Serial.print(F("samples "));
+    Serial.println(numSamples);
+    Serial.print(F("outside "));
+    Serial.println(numOutside);
+    for (u8 i = 0; i < NUM_BINS; ++i) {
+        if (!bins[i])
+            continue;
+        Serial.print(i);
+        Serial.print(' ');
+        Serial.println(bins[i]);
+    }
+    Serial.println(F("# end"));
+
+    TIMSK2 |= (1 << OCIE2A);
+}
+}
+
+/* Runs right after the trampoline below, as if it was the interrupt handler itself */
+extern "C" void __vector_profilerSample() __attribute__((signal, used));
+void __vector_profilerSample()
+{
+    using namespace Profiler;
+
+    ++numSamples;
+
+    const u16 bin = sampledPc >> binShift;
+    if (bin >= NUM_BINS)
+        ++numOutside;
+    else if (bins[bin] != 0xFFFF)
+        ++bins[bin];
+}
+
+/*
+ *  The return address is at the top of the stack only on entry, before any prologue. Save it,
+ *  restore the registers used and jump to the actual handler, which finds the stack exactly
+ *  as the interrupt left it.
+ */
+ISR(TIMER2_COMPA_vect, ISR_NAKED)
+{
+    asm volatile("push r30            \n\t"
+                 "push r31            \n\t"
+                 "in   r30, __SP_L__  \n\t"
+                 "in   r31, __SP_H__  \n\t"
+                 "push r24            \n\t"
+                 "ldd  r24, Z+3       \n\t" /* PC, high byte */
+                 "sts  %[pc]+1, r24   \n\t"
+                 "ldd  r24, Z+4       \n\t" /* PC, low byte */
+                 "sts  %[pc], r24     \n\t"
+                 "pop  r24            \n\t"
+                 "pop  r31            \n\t"
+                 "pop  r30            \n\t"
+                 "jmp  __vector_profilerSample \n\t"
+                 :
+                 : [pc] "i"(&Profiler::sampledPc));
+}
+#endif
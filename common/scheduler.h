@@ -0,0 +1,257 @@
+/*
+ *  Cooperative scheduler of periodic tasks, earliest deadline first.
+ *
+ *      static void sampleInput() { ... }
+ *      static void draw() { ... }
+ *
+ *      using Tasks = Scheduler::Tasks<
+ *          Scheduler::Task<sampleInput, 10>,   released every 10 ms, due 10 ms later
+ *          Scheduler::Task<draw, 40, 20>>;     released every 40 ms, due 20 ms later
+ *
+ *      void setup() { Tasks::begin(); }
+ *      void loop()
+ *      {
+ *          if (!Tasks::dispatch())
+ *              Tasks::idle();
+ *      }
+ *
+ *  Each call to `dispatch()` runs, to completion, the released task whose deadline is the
+ *  earliest, or nothing when no task is released. A task is released again one period after
+ *  its previous release, not after it ran, so its rate doesn't drift with the load.
+ *
+ *  `idle()` puts the CPU in idle sleep mode until the next interrupt, unless a task has been
+ *  released meanwhile. This is plain idle sleep, not tickless: it doesn't compute when the
+ *  next task is released, and Timer0's overflow, which `millis()` counts, keeps waking the CPU
+ *  up every 1.024 ms. A release is seen that soon after it's due, and so is input from any
+ *  other interrupt (joystick ADC, INT0, serial). Stopping the tick would stop `millis()` and
+ *  the interrupts that share Timer0 (hw-4's display, hw-5's input sampling, the music
+ *  players), and power-save mode would stop Timer0 too.
+ *
+ *  A run that ends after the task's deadline counts as a miss, and so does every release a
+ *  late task skips to catch up. Every task also keeps its number of runs and their total and
+ *  worst duration (`statsOf()`), and the scheduler the number of wake-ups from `idle()` and
+ *  the time spent asleep, the interrupts that woke it up included (`idleStats()`).
+ *  `make INSTRUMENTATION="TASKS"` adds the `t` (print them) and `T` (reset them) console
+ *  commands (see `console.h`). Task functions are printed as flash byte addresses, for
+ *  `avr-addr2line -f -C -e bin/<sketch>.elf <address>`.
+ */
+
+#pragma once
+#include <Arduino.h>
+#include <avr/sleep.h>
+
+namespace Scheduler {
+using Function = void (*)();
+
+struct Stats {
+    u16 misses;
+    u32 runs;
+    u32 totalUs;
+    u32 worstUs;
+};
+
+struct IdleStats {
+    u32 wakeups;
+    u32 sleptUs;
+    u32 sinceUs; /* Start of the statistics, by `micros()` */
+};
+
+template <Function RUN, u16 PERIOD_MS, u16 DEADLINE_MS = PERIOD_MS> struct Task {
+    static_assert(PERIOD_MS > 0, "a task needs a period");
+    static_assert(DEADLINE_MS > 0 && DEADLINE_MS <= PERIOD_MS, "due before the next release");
+
+    static constexpr Function run = RUN;
+    static constexpr u16 periodMs = PERIOD_MS;
+    static constexpr u16 deadlineMs = DEADLINE_MS;
+};
+
+#ifdef INSTRUMENT_TASKS
+/* Code addresses are in words on the AVR */
+#ifdef HOST_SIM
+static constexpr u8 CODE_ADDRESS_SCALE = 1;
+#else
+static constexpr u8 CODE_ADDRESS_SCALE = 2;
+#endif
+
+/* The scheduler the console reports on, shared by all translation units */
+template <typename = void> struct Console {
+    static void (*report)();
+    static void (*reset)();
+};
+template <typename T> void (*Console<T>::report)();
+template <typename T> void (*Console<T>::reset)();
+
+inline void report()
+{
+    if (Console<>::report)
+        Console<>::report();
+}
+
+inline void reset()
+{
+    if (Console<>::reset)
+        Console<>::reset();
+}
+#endif
+
+template <typename... TASKS> class Tasks {
+public:
+    static constexpr u8 NUM_TASKS = sizeof...(TASKS);
+
+    /* Releases every task now */
+    static void begin()
+    {
+        const auto now = millis();
+        for (auto& release : releases)
+            release = now;
+        idling.sinceUs = micros();
+
+#ifdef INSTRUMENT_TASKS
+        Scheduler::Console<>::report = report;
+        Scheduler::Console<>::reset = reset;
+#endif
+    }
+
+    /* Runs the released task with the earliest deadline. Returns false if none is released. */
+    static bool dispatch()
+    {
+        const auto now = millis();
+        u8 next = NUM_TASKS;
+        u32 nextDeadline = 0;
+        for (u8 i = 0; i < NUM_TASKS; ++i) {
+            if (before(now, releases[i]))
+                continue;
+
+            const auto deadline = releases[i] + DEADLINES_MS[i];
+            if (next == NUM_TASKS || before(deadline, nextDeadline)) {
+                next = i;
+                nextDeadline = deadline;
+            }
+        }
+        if (next == NUM_TASKS)
+            return false;
+
+        const auto startUs = micros();
+        RUNS[next]();
+        const auto durationUs = micros() - startUs;
+        const auto end = millis();
+
+        auto& taskStats = stats[next];
+        ++taskStats.runs;
+        taskStats.totalUs += durationUs;
+        if (durationUs > taskStats.worstUs)
+            taskStats.worstUs = durationUs;
+        if (before(nextDeadline, end))
+            countMiss(taskStats);
+
+        /* The releases that are already over are skipped */
+        auto& release = releases[next];
+        release += PERIODS_MS[next];
+        while (!before(end, release + PERIODS_MS[next])) {
+            release += PERIODS_MS[next];
+            countMiss(taskStats);
+        }
+        return true;
+    }
+
+    /* Sleeps until the next interrupt (a tick at the latest), unless a task is released */
+    static void idle()
+    {
+        cli();
+        const auto now = millis();
+        for (const auto release : releases) {
+            if (!before(now, release)) {
+                sei();
+                return;
+            }
+        }
+
+        const auto startUs = micros();
+        set_sleep_mode(SLEEP_MODE_IDLE);
+        sleep_enable();
+        /* `sleep` runs before the interrupts `sei` lets in, which then wake the CPU up */
+        sei();
+        sleep_cpu();
+        sleep_disable();
+
+        ++idling.wakeups;
+        idling.sleptUs += micros() - startUs;
+    }
+
+    /* In the order of the template arguments */
+    static const Stats& statsOf(const u8 index) { return stats[index]; }
+
+    static const IdleStats& idleStats() { return idling; }
+
+private:
+    /* Whether timestamp `a` comes before `b`, across the wrap of `millis()` */
+    static bool before(const u32 a, const u32 b) { return int32_t(a - b) < 0; }
+
+    static void countMiss(Stats& taskStats)
+    {
+        if (taskStats.misses != 0xFFFF)
+            ++taskStats.misses;
+    }
+
+#ifdef INSTRUMENT_TASKS
+    /* The configuration and the statistics of each task */
+    static void report()
+    {
+        Serial.println(F("# tasks"));
+        Serial.println(F("task\tperiod_ms\tdeadline_ms\truns\tmisses\tmean_us\tworst_us"));
+        for (u8 i = 0; i < NUM_TASKS; ++i) {
+            const auto& taskStats = stats[i];
+            const auto address
+                = static_cast<unsigned long>(reinterpret_cast<uintptr_t>(RUNS[i]));
+            Serial.print(F("0x"));
+            Serial.print(address * CODE_ADDRESS_SCALE, HEX);
+            Serial.print('\t');
+            Serial.print(PERIODS_MS[i]);
+            Serial.print('\t');
+            Serial.print(DEADLINES_MS[i]);
+            Serial.print('\t');
+            Serial.print(taskStats.runs);
+            Serial.print('\t');
+            Serial.print(taskStats.misses);
+            Serial.print('\t');
+            Serial.print(taskStats.runs ? taskStats.totalUs / taskStats.runs : 0);
+            Serial.print('\t');
+            Serial.println(taskStats.worstUs);
+        }
+
+        /* Over at most 71 minutes, when `micros()` wraps */
+        const auto elapsedUs = micros() - idling.sinceUs;
+        Serial.print(F("wakeups "));
+        Serial.println(idling.wakeups);
+        Serial.print(F("slept_us "));
+        Serial.println(idling.sleptUs);
+        Serial.print(F("elapsed_us "));
+        Serial.println(elapsedUs);
+        Serial.print(F("sleep_percent "));
+        Serial.println(elapsedUs >= 100 ? idling.sleptUs / (elapsedUs / 100) : 0);
+        Serial.println(F("# end"));
+    }
+
+    static void reset()
+    {
+        memset(stats, 0, sizeof(stats));
+        idling = { 0, 0, micros() };
+    }
+#endif
+
+    static constexpr Function RUNS[NUM_TASKS] = { TASKS::run... };
+    static constexpr u16 PERIODS_MS[NUM_TASKS] = { TASKS::periodMs... };
+    static constexpr u16 DEADLINES_MS[NUM_TASKS] = { TASKS::deadlineMs... };
+
+    static u32 releases[NUM_TASKS];
+    static Stats stats[NUM_TASKS];
+    static IdleStats idling;
+};
+
+template <typename... TASKS> constexpr Function Tasks<TASKS...>::RUNS[NUM_TASKS];
+template <typename... TASKS> constexpr u16 Tasks<TASKS...>::PERIODS_MS[NUM_TASKS];
+template <typename... TASKS> constexpr u16 Tasks<TASKS...>::DEADLINES_MS[NUM_TASKS];
+template <typename... TASKS> u32 Tasks<TASKS...>::releases[NUM_TASKS];
+template <typename... TASKS> Stats Tasks<TASKS...>::stats[NUM_TASKS];
+template <typename... TASKS> IdleStats Tasks<TASKS...>::idling;
+}
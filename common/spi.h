@@ -0,0 +1,66 @@
+/*
+ *  Write-only SPI transports, for shift-register style chips (74HC595, MAX7219).
+ *
+ *      using Bus = Spi::Hardware<>;       SPI peripheral: MOSI (11) and SCK (13), 8 MHz
+ *      using Bus = Spi::BitBang<12, 11>;  any data and clock pins
+ *
+ *      Bus::begin();
+ *      Bus::transfer(0x42);
+ *
+ *  Both send the most significant bit first (unless `LSB_FIRST` is set), in mode 0: data is
+ *  shifted in on the rising edge of the clock. Chip select/latch lines belong to the chip
+ *  drivers (`hc595.h`, `max7219.h`).
+ *
+ *  The peripheral sends a byte in 16 cycles and is polled: a transfer is shorter than entering
+ *  and leaving an interrupt handler, so draining a queue from the SPI interrupt would cost
+ *  more CPU time than it frees. Pin 10 (SS) must stay an output, otherwise the peripheral can
+ *  drop out of master mode; the sketches use it as their latch.
+ */
+
+#pragma once
+#include "fastpin.h"
+#include <Arduino.h>
+
+namespace Spi {
+static constexpr u8 SS_PIN = 10;
+static constexpr u8 MOSI_PIN = 11;
+static constexpr u8 SCK_PIN = 13;
+
+template <bool LSB_FIRST = false> struct Hardware {
+    static void begin()
+    {
+        FastPin::Pin<SS_PIN>::output();
+        FastPin::Pin<MOSI_PIN>::output();
+        FastPin::Pin<SCK_PIN>::output();
+
+        /* Master, clk/2 */
+        SPCR = u8((1 << SPE) | (1 << MSTR) | (LSB_FIRST ? 1 << DORD : 0));
+        SPSR = (1 << SPI2X);
+    }
+
+    static void transfer(const u8 value)
+    {
+        SPDR = value;
+        while (!(SPSR & (1 << SPIF)))
+            ;
+    }
+};
+
+template <u8 DATA_PIN, u8 CLOCK_PIN, bool LSB_FIRST = false> struct BitBang {
+    static void begin()
+    {
+        FastPin::Pin<DATA_PIN>::output();
+        FastPin::Pin<CLOCK_PIN>::output();
+    }
+
+    static void transfer(u8 value)
+    {
+        for (u8 i = 0; i < 8; ++i) {
+            FastPin::Pin<DATA_PIN>::write(value & (LSB_FIRST ? 0x01 : 0x80));
+            FastPin::Pin<CLOCK_PIN>::high();
+            FastPin::Pin<CLOCK_PIN>::low();
+            value = LSB_FIRST ? u8(value >> 1) : u8(value << 1);
+        }
+    }
+};
+}
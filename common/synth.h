@@ -0,0 +1,280 @@
+/*
+ *  Polyphonic synthesizer: 2 to 4 voices of direct digital synthesis mixed into a PWM output.
+ *
+ *      using Organ = Dds::Synth<2>;                    2 voices, on pin 3
+ *      ISR(TIMER1_COMPB_vect) { Organ::sample(); }
+ *      ISR(TIMER0_COMPA_vect) { Organ::tick(); }
+ *
+ *      Organ::begin();                                 in `setup()`
+ *      Organ::play(0, PART(LITTLE_FUGUE_IN_G_MINOR, 10000));
+ *      Organ::play(1, PART(LITTLE_FUGUE_IN_G_MINOR, 10000), 1);     an octave lower
+ *
+ *  Every sample, each voice adds its note's increment to a 16-bit phase accumulator and looks
+ *  the top 6 bits of the phase up in a 64-entry sine table in flash. The Timer1 compare B
+ *  interrupt mixes the voices 15625 times per second (every 1024 cycles) into the duty cycle
+ *  of Timer2's fast PWM, whose 62.5 kHz carrier is out of hearing (an RC low-pass on the pin
+ *  smooths it out for a speaker). Frequencies are exact to 0.24 Hz, up to 7.8 kHz.
+ *
+ *  A part is a `Note` table compiled by `PART()` the way `MELODY()` compiles a melody (see
+ *  `music.h`), into each note's increment and duration. Each voice loops over its own part,
+ *  ticking on the Timer0 compare A interrupt (1.024 ms) like `MelodyPlayer`.
+ *
+ *  The sample interrupt is budgeted a quarter of its period, `CYCLE_BUDGET`, so that with
+ *  every voice playing the main loop and the other interrupts keep 3/4 of the CPU. Estimated
+ *  from its instruction sequence, not measured yet: ~60 cycles plus ~30 per voice, ~180 for 4
+ *  voices. `make INSTRUMENTATION="SYNTH"` measures it on the board with `TCNT1` (in steps of 8
+ *  cycles) and adds the `a` (print the samples, the mean and worst cycles per sample and how
+ *  many went over budget) and `A` (reset them) console commands (see `console.h`).
+ *
+ *  Claims Timer2 (so not with `MelodyPlayer`, `tone()` or the profiler), Timer1 compare B and
+ *  Timer0 compare A. Timer1 runs free at clk/8 as for `hd44780.h` and `zones.h`, so the three
+ *  can be built together (and `analogWrite()` on pins 9 and 10 stops working). A sample that
+ *  comes late, behind other interrupts, schedules the next one from the time it ran instead.
+ */
+
+#pragma once
+
+#ifdef INSTRUMENT_PROFILER
+#error "the profiler claims Timer2, which the synthesizer outputs on"
+#endif
+
+#include "music.h"
+#include <Arduino.h>
+
+#define PART(notes, totalMs)                                                                 \
+    Music::compile<Dds::VoiceNote, Dds::pack, notes, sizeof(notes) / sizeof(notes[0]),        \
+        totalMs>()
+
+namespace Dds {
+static constexpr u16 SAMPLE_TICKS = 128; /* Of Timer1, at clk/8 */
+static constexpr unsigned long SAMPLE_CYCLES = 8UL * SAMPLE_TICKS;
+static constexpr u16 CYCLE_BUDGET = SAMPLE_CYCLES / 4;
+static constexpr u8 START_TICKS = 16; /* From now to the soonest sample */
+
+struct VoiceNote {
+    u16 increment; /* Of the phase every sample, 0 for a rest */
+    u16 ticks;
+};
+
+using Part = NoteStream<VoiceNote>;
+
+/* A full turn of the phase is 65536 */
+constexpr u16 incrementOf(const unsigned freq)
+{
+    return u16((65536ULL * SAMPLE_CYCLES * freq + F_CPU / 2) / F_CPU);
+}
+
+constexpr VoiceNote pack(
+    const Note* notes, const size_t count, const u32 totalMs, const size_t index)
+{
+    return VoiceNote {
+        incrementOf(notes[index].freq),
+        Music::ticksOf(notes, count, totalMs, index),
+    };
+}
+
+/* A period, from -127 to 127 */
+static const int8_t SINE[64] PROGMEM = {
+    0, 12, 25, 37, 49, 60, 71, 81,
+    90, 98, 106, 112, 117, 122, 125, 126,
+    127, 126, 125, 122, 117, 112, 106, 98,
+    90, 81, 71, 60, 49, 37, 25, 12,
+    0, -12, -25, -37, -49, -60, -71, -81,
+    -90, -98, -106, -112, -117, -122, -125, -126,
+    -127, -126, -125, -122, -117, -112, -106, -98,
+    -90, -81, -71, -60, -49, -37, -25, -12,
+};
+
+#ifdef INSTRUMENT_SYNTH
+/* Estimated: the interrupt response, pushes, pops and `reti`, which `TCNT1` doesn't see */
+static constexpr u8 ENTRY_EXIT_CYCLES = 40;
+
+/* Cost of the sample interrupt, shared by all translation units */
+template <typename = void> struct Load {
+    static u32 samples;
+    static u32 totalCycles;
+    static u16 worstCycles;
+    static u16 overBudget;
+};
+template <typename T> u32 Load<T>::samples;
+template <typename T> u32 Load<T>::totalCycles;
+template <typename T> u16 Load<T>::worstCycles;
+template <typename T> u16 Load<T>::overBudget;
+
+inline void record(const u16 cycles)
+{
+    ++Load<>::samples;
+    Load<>::totalCycles += cycles;
+    if (cycles > Load<>::worstCycles)
+        Load<>::worstCycles = cycles;
+    if (cycles > CYCLE_BUDGET && Load<>::overBudget != 0xFFFF)
+        ++Load<>::overBudget;
+}
+
+inline void report()
+{
+    const u8 sreg = SREG;
+    cli();
+    const auto samples = Load<>::samples;
+    const auto totalCycles = Load<>::totalCycles;
+    const auto worstCycles = Load<>::worstCycles;
+    const auto overBudget = Load<>::overBudget;
+    SREG = sreg;
+
+    Serial.println(F("# synth"));
+    Serial.print(F("samples "));
+    Serial.println(samples);
+    Serial.print(F("mean_cycles "));
+    Serial.println(samples ? totalCycles / samples : 0);
+    Serial.print(F("worst_cycles "));
+    Serial.println(worstCycles);
+    Serial.print(F("budget_cycles "));
+    Serial.println(CYCLE_BUDGET);
+    Serial.print(F("over_budget "));
+    Serial.println(overBudget);
+    Serial.println(F("# end"));
+}
+
+inline void reset()
+{
+    const u8 sreg = SREG;
+    cli();
+    Load<>::samples = 0;
+    Load<>::totalCycles = 0;
+    Load<>::worstCycles = 0;
+    Load<>::overBudget = 0;
+    SREG = sreg;
+}
+#endif
+
+template <u8 VOICES, u8 PIN = 3> class Synth {
+    static_assert(VOICES >= 2 && VOICES <= 4, "2 to 4 voices");
+    static_assert(PIN == 3 || PIN == 11, "Timer2's outputs are on pins 3 and 11");
+
+public:
+    /* Starts the PWM output at its midpoint and the interrupts, every voice silent */
+    static void begin()
+    {
+        stop();
+        memset(voices, 0, sizeof(voices));
+        pinMode(PIN, OUTPUT);
+        output(0x80);
+        TCCR2A = u8((1 << WGM21) | (1 << WGM20) | (PIN == 11 ? (1 << COM2A1) : (1 << COM2B1)));
+        TCCR2B = (1 << CS20);
+
+        TCCR1A = 0;
+        TCCR1B = (1 << CS11);
+        const u8 sreg = SREG;
+        cli();
+        OCR1B = u16(TCNT1 + SAMPLE_TICKS);
+        /* Set by any earlier match, it would sample at once */
+        TIFR1 = (1 << OCF1B);
+        TIMSK1 |= (1 << OCIE1B);
+        TIMSK0 |= (1 << OCIE0A);
+        SREG = sreg;
+    }
+
+    static void stop()
+    {
+        TIMSK1 &= u8(~(1 << OCIE1B));
+        TIMSK0 &= u8(~(1 << OCIE0A));
+        TCCR2B = 0;
+        TCCR2A = 0;
+    }
+
+    /* Loops `voice` over `part` from its first note, `octavesDown` octaves lower */
+    static void play(const u8 voice, const Part part, const u8 octavesDown = 0)
+    {
+        const u8 sreg = SREG;
+        cli();
+        auto& v = voices[voice];
+        v.part = part;
+        v.octavesDown = octavesDown;
+        v.i = 0;
+        v.elapsed = 0;
+        startNote(v);
+        SREG = sreg;
+    }
+
+    static void silence(const u8 voice)
+    {
+        const u8 sreg = SREG;
+        cli();
+        voices[voice] = Voice {};
+        SREG = sreg;
+    }
+
+    /* Runs in the Timer1 compare B interrupt */
+    static void sample()
+    {
+        /* Unless that's already past, and `OCR1B` would only match after a wrap of Timer1 */
+        const u16 start = TCNT1;
+        const auto late = int16_t(start - OCR1B); /* Negative if it ran early */
+        OCR1B = late + START_TICKS < int16_t(SAMPLE_TICKS) ? u16(OCR1B + SAMPLE_TICKS)
+                                                           : u16(start + START_TICKS);
+
+        /* The sum of 3 or 4 voices is scaled down as that of 4 */
+        int16_t mix = 0;
+        for (auto& v : voices) {
+            v.phase = u16(v.phase + v.increment);
+            mix = int16_t(mix + int8_t(pgm_read_byte(&SINE[v.phase >> 10])));
+        }
+        output(u8(0x80 + (mix >> (VOICES > 2 ? 2 : 1))));
+
+#ifdef INSTRUMENT_SYNTH
+        record(u16(u16(TCNT1 - start) * 8 + ENTRY_EXIT_CYCLES));
+#endif
+    }
+
+    /* Runs in the Timer0 compare A interrupt */
+    static void tick()
+    {
+        for (auto& v : voices) {
+            if (!v.part.count || ++v.elapsed < v.ticks)
+                continue;
+
+            /* Notes shorter than half a tick are skipped */
+            v.elapsed = 0;
+            do {
+                if (++v.i == v.part.count)
+                    v.i = 0;
+                startNote(v);
+            } while (!v.ticks);
+        }
+    }
+
+private:
+    struct Voice {
+        u16 phase;
+        u16 increment; /* Of note `i`, 0 when it's a rest */
+        Part part; /* Empty when silent */
+        u16 i;
+        u16 ticks; /* Of note `i` */
+        u16 elapsed; /* Since note `i` started */
+        u8 octavesDown;
+    };
+
+    static void output(const u8 duty)
+    {
+        if (PIN == 11)
+            OCR2A = duty;
+        else
+            OCR2B = duty;
+    }
+
+    static void startNote(Voice& v)
+    {
+        const auto& note = v.part.notes[v.i];
+        v.ticks = pgm_read_word(&note.ticks);
+        v.increment = u16(pgm_read_word(&note.increment) >> v.octavesDown);
+        /* A rest holds the phase at 0, where the sine is 0 */
+        if (!v.increment)
+            v.phase = 0;
+    }
+
+    static Voice voices[VOICES];
+};
+
+template <u8 VOICES, u8 PIN>
+typename Synth<VOICES, PIN>::Voice Synth<VOICES, PIN>::voices[VOICES];
+}
@@ -0,0 +1,98 @@
+/*
+ *  Input traces: recording and deterministic replay of the input a sketch reacts to.
+ *
+ *  The sketch packs its input of one loop iteration into a nonzero byte (0 means "no input").
+ *  Only iterations with input are recorded, each as:
+ *
+ *      varint  milliseconds since the previous record (since reset for the first one), LEB128
+ *      u8      input
+ *
+ *  `make INSTRUMENTATION="TRACE"` streams the records over serial from reset (capture them
+ *  with `tools/trace.py capture`); the serial port must not be shared with other binary
+ *  output (e.g. `LOG`).
+ *
+ *  `make INSTRUMENTATION="REPLAY"` plays back a trace from flash instead: each record is
+ *  delivered exactly once, on the first iteration at or after its timestamp, along with the
+ *  timestamp it was recorded at. The trace is compiled in from `replay.h` in the sketch's
+ *  directory (see `tools/trace.py header`).
+ */
+
+#pragma once
+#include <Arduino.h>
+
+namespace Trace {
+#ifdef INSTRUMENT_TRACE
+template <typename = void> struct Recorder {
+    static u32 previousTs;
+};
+template <typename T> u32 Recorder<T>::previousTs;
+
+inline void record(const u32 currentTs, const u8 input)
+{
+    if (!input)
+        return;
+
+    auto delta = currentTs - Recorder<>::previousTs;
+    Recorder<>::previousTs = currentTs;
+    while (delta >= 0x80) {
+        Serial.write(u8(delta | 0x80));
+        delta >>= 7;
+    }
+    Serial.write(u8(delta));
+    Serial.write(input);
+}
+#endif
+
+#ifdef INSTRUMENT_REPLAY
+template <typename = void> struct Player {
+    static const u8* data; /* In flash */
+    static u16 size;
+    static u16 offset;
+    static u32 nextTs;
+    static u8 nextInput; /* 0 once the trace is over */
+};
+template <typename T> const u8* Player<T>::data;
+template <typename T> u16 Player<T>::size;
+template <typename T> u16 Player<T>::offset;
+template <typename T> u32 Player<T>::nextTs;
+template <typename T> u8 Player<T>::nextInput;
+
+/* Decodes the next record, if any */
+inline void loadNext()
+{
+    using P = Player<>;
+
+    u32 delta = 0;
+    for (u8 shift = 0; P::offset < P::size; shift = u8(shift + 7)) {
+        const auto byte = pgm_read_byte(P::data + P::offset++);
+        delta |= u32(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            break;
+    }
+
+    P::nextInput = P::offset < P::size ? pgm_read_byte(P::data + P::offset++) : 0;
+    P::nextTs += delta;
+}
+
+inline void beginReplay(const u8* progmemData, const u16 size)
+{
+    Player<>::data = progmemData;
+    Player<>::size = size;
+    Player<>::offset = 0;
+    Player<>::nextTs = 0;
+    loadNext();
+}
+
+/* Returns the input due at `currentTs` (0 if none) and moves `currentTs` to its recording */
+inline u8 replay(u32& currentTs)
+{
+    const auto input = Player<>::nextInput;
+    if (!input || currentTs < Player<>::nextTs)
+        return 0;
+
+    currentTs = Player<>::nextTs;
+    loadNext();
+    return input;
+}
+#endif
+}
@@ -0,0 +1,152 @@
+/*
+ *  Zone timers: count, min, max and total time spent in a region of code, measured in Timer1
+ *  ticks.
+ *
+ *      ZONE(updateZone, "DisplayController::update");
+ *
+ *      void DisplayController::update(...)
+ *      {
+ *          const Zones::Scope scope(updateZone);
+ *          ...
+ *      }
+ *
+ *  Zone names live in flash. Send `z` over the console (see `console.h`) to print the
+ *  statistics of every zone, `Z` to reset them.
+ *
+ *  Built only with `make INSTRUMENTATION="ZONES"`, otherwise zones and scopes are empty.
+ *  Claims Timer1, free-running at clk/8 (so `analogWrite()` on pins 9 and 10 stops working):
+ *  a single pass through a zone can take at most 32.7 ms.
+ */
+
+#pragma once
+#include <Arduino.h>
+
+#ifdef INSTRUMENT_ZONES
+namespace Zones {
+static constexpr u8 TICK_CYCLES = 8;
+
+class Zone;
+
+/* Head of the list of zones, shared by all translation units */
+template <typename = void> struct Registry {
+    static Zone* head;
+};
+template <typename T> Zone* Registry<T>::head = nullptr;
+
+class Zone {
+public:
+    explicit Zone(const char* progmemName)
+        : name(progmemName)
+        , next(Registry<>::head)
+    {
+        reset();
+        Registry<>::head = this;
+    }
+
+    void record(const u16 ticks)
+    {
+        ++count;
+        totalTicks += ticks;
+        if (ticks < minTicks)
+            minTicks = ticks;
+        if (ticks > maxTicks)
+            maxTicks = ticks;
+    }
+
+    void reset()
+    {
+        count = 0;
+        totalTicks = 0;
+        minTicks = 0xFFFF;
+        maxTicks = 0;
+    }
+
+public:
+    const char* name;
+    Zone* next;
+    u32 count;
+    u32 totalTicks;
+    u16 minTicks;
+    u16 maxTicks;
+};
+
+class Scope {
+public:
+    explicit Scope(Zone& zone)
+        : zone(zone)
+        , start(now())
+    {
+    }
+    ~Scope() { zone.record(u16(now() - start)); }
+
+private:
+    /* Interrupts off, or one writing a Timer1 register could clobber `TCNT1`'s high byte */
+    static u16 now()
+    {
+        const u8 sreg = SREG;
+        cli();
+        const u16 ticks = TCNT1;
+        SREG = sreg;
+        return ticks;
+    }
+
+    Zone& zone;
+    u16 start;
+};
+
+inline void begin()
+{
+    TCCR1A = 0;
+    TCCR1B = (1 << CS11);
+    TCNT1 = 0;
+}
+
+inline void reset()
+{
+    for (auto zone = Registry<>::head; zone; zone = zone->next)
+        zone->reset();
+}
+
+/* One row per zone: count, min/mean/max cycles per pass and total milliseconds */
+inline void report()
+{
+    static constexpr u32 TICKS_PER_MS = F_CPU / 1000 / TICK_CYCLES;
+
+    Serial.println(F("# zones"));
+    Serial.println(F("name\tcount\tmin\tmean\tmax\ttotal_ms"));
+    for (auto zone = Registry<>::head; zone; zone = zone->next) {
+        if (!zone->count)
+            continue;
+
+        Serial.print(reinterpret_cast<const __FlashStringHelper*>(zone->name));
+        Serial.print('\t');
+        Serial.print(zone->count);
+        Serial.print('\t');
+        Serial.print(u32(zone->minTicks) * TICK_CYCLES);
+        Serial.print('\t');
+        Serial.print(zone->totalTicks / zone->count * TICK_CYCLES);
+        Serial.print('\t');
+        Serial.print(u32(zone->maxTicks) * TICK_CYCLES);
+        Serial.print('\t');
+        Serial.println(zone->totalTicks / TICKS_PER_MS);
+    }
+    Serial.println(F("# end"));
+}
+}
+
+#define ZONE(var, name)                                                                      \
+    static const char var##Name[] PROGMEM = name;                                            \
+    static Zones::Zone var(var##Name)
+#else
+namespace Zones {
+struct Zone {
+};
+
+class Scope {
+public:
+    explicit Scope(Zone&) { }
+};
+}
+
+#define ZONE(var, name) static Zones::Zone var
+#endif
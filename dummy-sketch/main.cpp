@@ -15,6 +15,7 @@
  *  interval.
  */
 
+#include "common/bench.h"
 #include <Arduino.h>
 
 static constexpr unsigned long INTERVAL = 100;
@@ -42,6 +43,8 @@ main()
 {
         init();
         setup();
-        for (;;)
+        for (;;) {
+                Bench::markLoop();
                 loop();
+        }
 }
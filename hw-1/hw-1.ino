@@ -1,3 +1,5 @@
+#include "common/bench.h"
+#include "common/scheduler.h"
 #include "utils.h"
 #include <Arduino.h>
 
@@ -33,22 +35,34 @@ static constexpr LedController LED_CONTROLLERS[NUM_LEDS] = {
     { A2, 11 },
 };
 
+static void updateLeds()
+{
+    for (auto& lc : LED_CONTROLLERS)
+        lc.update();
+}
+
+/* The potentiometers are turned by hand, 50 Hz keeps up with them */
+using Tasks = Scheduler::Tasks<Scheduler::Task<updateLeds, 20>>;
+
 void setup()
 {
     for (auto& lc : LED_CONTROLLERS)
         lc.init();
+    Tasks::begin();
 }
 
 void loop()
 {
-    for (auto& lc : LED_CONTROLLERS)
-        lc.update();
+    if (!Tasks::dispatch())
+        Tasks::idle();
 }
 
 int main()
 {
     init();
     setup();
-    for (;;)
+    for (;;) {
+        Bench::markLoop();
         loop();
+    }
 }
@@ -1,3 +1,6 @@
+#include "common/bench.h"
+#include "common/fastpin.h"
+#include "common/scheduler.h"
 #include <Arduino.h>
 #include <limits.h>
 
@@ -63,17 +66,22 @@ static uint8_t currentCrossState;
 static unsigned long prevTs;
 
 /* Functions */
-static bool buttonIsPressed() { return digitalRead(BUTTON_PIN) == LOW; }
+static bool buttonIsPressed() { return !FastPin::Pin<BUTTON_PIN>::read(); }
 
 static void updateLeds(const uint8_t ledStates)
 {
-    static constexpr uint8_t MASK = 1;
-    for (uint8_t i = 0; i < NumLeds; ++i) {
-        const uint8_t value = ledStates & (MASK << i);
-        digitalWrite(LED_OUTPUT_PINS[i], bool(value));
-    }
+    using LedPins = FastPin::PinSet<LED_OUTPUT_PINS[Led::PedRed],
+        LED_OUTPUT_PINS[Led::PedGreen], LED_OUTPUT_PINS[Led::CarRed],
+        LED_OUTPUT_PINS[Led::CarYellow], LED_OUTPUT_PINS[Led::CarGreen]>;
+
+    LedPins::write(ledStates);
 }
 
+static void updateCrosswalk();
+
+/* Samples the button and times the lights and the buzzer */
+using Tasks = Scheduler::Tasks<Scheduler::Task<updateCrosswalk, 10>>;
+
 void setup()
 {
     /* Init crosswalk state */
@@ -92,9 +100,11 @@ void setup()
 
     /* Init LED states */
     updateLeds(LED_STATES[CrossState::PedRedLight]);
+
+    Tasks::begin();
 }
 
-void loop()
+static void updateCrosswalk()
 {
     const uint8_t oldCrossState = currentCrossState;
     const auto currentTs = millis();
@@ -126,7 +136,7 @@ void loop()
         else
             noTone(BUZZER_PIN);
 
-        digitalWrite(LED_OUTPUT_PINS[Led::PedGreen], oddInterval);
+        FastPin::Pin<LED_OUTPUT_PINS[Led::PedGreen]>::write(oddInterval);
     default:
         break;
     }
@@ -150,10 +160,18 @@ void loop()
     }
 }
 
+void loop()
+{
+    if (!Tasks::dispatch())
+        Tasks::idle();
+}
+
 int main()
 {
     init();
     setup();
-    for (;;)
+    for (;;) {
+        Bench::markLoop();
         loop();
+    }
 }
@@ -1,4 +1,5 @@
 #include "DisplayController.h"
+#include "common/fastpin.h"
 
 constexpr DisplayController::NodeNeighbours DisplayController::NODE_NEIGHBOURS[NumNodes];
 constexpr u8 DisplayController::NODE_PINS[NumNodes];
@@ -60,8 +61,10 @@ void DisplayController::update(const u32 currentTs, JoystickController& joystick
 
 void DisplayController::drawNodes(const Bitset8 nodeStates)
 {
-    for (u32 i = 0; i < NumNodes; ++i) {
-        const auto nodeValue = u8((nodeStates >> i) & 1);
-        digitalWrite(NODE_PINS[i], nodeValue);
-    }
+    /* Pins 4-7 are on port D and 8-11 on port B: two register writes */
+    using NodePins = FastPin::PinSet<NODE_PINS[Node::A], NODE_PINS[Node::B],
+        NODE_PINS[Node::C], NODE_PINS[Node::D], NODE_PINS[Node::E], NODE_PINS[Node::F],
+        NODE_PINS[Node::G], NODE_PINS[Node::DP]>;
+
+    NodePins::write(nodeStates);
 }
@@ -1,4 +1,6 @@
 #include "DisplayController.h"
+#include "common/bench.h"
+#include "common/scheduler.h"
 
 /* Compile-time constants */
 static constexpr u8 BUTTON_PIN = 2;
@@ -8,18 +10,30 @@ static JoystickController joystickController(BUTTON_PIN, A1, A0);
 static DisplayController displayController;
 
 /* Functions */
+static void update() { displayController.update(millis(), joystickController); }
+
+/* Also the button's sampling period, which filters out its bounces */
+using Tasks = Scheduler::Tasks<Scheduler::Task<update, 10>>;
+
 void setup()
 {
     displayController.init();
     joystickController.init();
+    Tasks::begin();
 }
 
-void loop() { displayController.update(millis(), joystickController); }
+void loop()
+{
+    if (!Tasks::dispatch())
+        Tasks::idle();
+}
 
 int main()
 {
     init();
     setup();
-    for (;;)
+    for (;;) {
+        Bench::markLoop();
         loop();
+    }
 }
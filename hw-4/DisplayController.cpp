@@ -1,26 +1,39 @@
 #include "DisplayController.h"
+#include "common/fastpin.h"
+#include "common/zones.h"
 
 using i8 = int8_t;
 
 constexpr u8 DisplayController::SECTION_PINS[NumSections];
 constexpr u8 DisplayController::DIGIT_NODE_STATES[NUM_DIGITS];
 
+DisplayController displayController;
+
+ZONE(updateZone, "DisplayController::update");
+
 void DisplayController::init()
 {
-    pinMode(DATA_PIN, OUTPUT);
-    pinMode(LATCH_PIN, OUTPUT);
-    pinMode(CLOCK_PIN, OUTPUT);
+    ShiftRegister::begin();
 
     for (auto pin : SECTION_PINS)
         pinMode(pin, OUTPUT);
+
+    /*
+     *  Refresh one section per Timer0 overflow period: 1.024 ms, ~244 Hz for the whole
+     *  display. Timer0 keeps running `millis()`, only its compare match A interrupt is added.
+     */
+    OCR0A = 0x80;
+    TIMSK0 |= (1 << OCIE0A);
 }
 
 void DisplayController::update(const u32 currentTs, JoystickController& joystickController)
 {
+    const Zones::Scope scope(updateZone);
+
     static constexpr u32 SELECTED_BLINK_INTERVAL = 256;
 
     const auto joystickDir = joystickController.getDirection();
-    const auto joyPress = joystickController.getButtonValue(currentTs);
+    const auto joyPress = joystickController.getButtonValue();
 
     Bitset8 nodeStates;
     switch (currentState) {
@@ -70,24 +83,36 @@ void DisplayController::update(const u32 currentTs, JoystickController& joystick
         UNREACHABLE;
     }
 
-    drawDigit(nodeStates);
+    drawFrame(nodeStates);
 }
 
-void DisplayController::drawDigit(const Bitset8 nodeStates)
+void DisplayController::drawFrame(const Bitset8 nodeStates)
 {
-    static constexpr u8 MULTIPLEXING_DELAY_DUR = 5;
+    const auto backFrame = u8(frontFrame ^ 1);
+    for (u8 sectionIter = 0; sectionIter < NumSections; ++sectionIter)
+        frames[backFrame][sectionIter] = sectionIter == currentSection
+            ? nodeStates
+            : DIGIT_NODE_STATES[sectionDigits[sectionIter]];
 
-    for (u8 sectionIter = 0; sectionIter < NumSections; ++sectionIter) {
-        digitalWrite(LATCH_PIN, LOW);
-        shiftOut(DATA_PIN, CLOCK_PIN, LSBFIRST,
-            sectionIter == currentSection ? nodeStates
-                                          : DIGIT_NODE_STATES[sectionDigits[sectionIter]]);
-        digitalWrite(LATCH_PIN, HIGH);
+    frontFrame = backFrame;
+}
 
-        for (u8 i = 0; i < NumSections; ++i)
-            digitalWrite(SECTION_PINS[i], HIGH);
-        digitalWrite(SECTION_PINS[sectionIter], LOW);
+/* Shows the next section. Runs in the timer interrupt. */
+void DisplayController::refresh()
+{
+    using SectionPins = FastPin::PinSet<SECTION_PINS[Section::D1], SECTION_PINS[Section::D2],
+        SECTION_PINS[Section::D3], SECTION_PINS[Section::D4]>;
+    static constexpr Bitset8 ALL_SECTIONS_OFF = (1 << NumSections) - 1; /* Active low */
 
-        delay(MULTIPLEXING_DELAY_DUR);
-    }
+    const auto nodeStates = frames[frontFrame][refreshedSection];
+
+    /* Blank the display while the shift register changes, or the previous section flickers */
+    SectionPins::write(ALL_SECTIONS_OFF);
+
+    ShiftRegister::write(nodeStates);
+
+    SectionPins::write(Bitset8(ALL_SECTIONS_OFF & ~(1 << refreshedSection)));
+    refreshedSection = u8((refreshedSection + 1) % NumSections);
 }
+
+ISR(TIMER0_COMPA_vect) { displayController.refresh(); }
@@ -1,5 +1,6 @@
 #pragma once
 #include "JoystickController.h"
+#include "common/hc595.h"
 
 class DisplayController {
 public:
@@ -30,10 +31,21 @@ public:
 
     void init();
     void update(u32 currentTs, JoystickController& joystickController);
+    void refresh();
 
+#ifdef HARDWARE_SPI
+    static constexpr u8 DATA_PIN = Spi::MOSI_PIN;
+    static constexpr u8 LATCH_PIN = Spi::SS_PIN;
+    static constexpr u8 CLOCK_PIN = Spi::SCK_PIN;
+    using SegmentBus = Spi::Hardware<true>;
+#else
     static constexpr u8 DATA_PIN = 12;
     static constexpr u8 LATCH_PIN = 11;
     static constexpr u8 CLOCK_PIN = 10;
+    using SegmentBus = Spi::BitBang<DATA_PIN, CLOCK_PIN, true>;
+#endif
+    /* Node `i` is bit `i`, sent first */
+    using ShiftRegister = Hc595<SegmentBus, LATCH_PIN>;
     static constexpr u8 NUM_DIGITS = 16;
     static constexpr u8 SECTION_PINS[NumSections] = {
         [Section::D1] = 7,
@@ -62,10 +74,17 @@ public:
     };
 
 private:
-    void drawDigit(Bitset8 nodeStates);
+    void drawFrame(Bitset8 nodeStates);
 
 private:
     Tiny::Array<u8, NumSections> sectionDigits;
     u8 currentSection;
     State currentState;
+
+    /* Node states per section: `refresh()` shows the front frame, `update()` draws the back */
+    volatile Bitset8 frames[2][NumSections];
+    volatile u8 frontFrame;
+    u8 refreshedSection;
 };
+
+extern DisplayController displayController;
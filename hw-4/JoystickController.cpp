@@ -1,26 +1,36 @@
 #include "JoystickController.h"
+#include "common/zones.h"
+
+ZONE(getDirectionZone, "JoystickController::getDirection");
 
 void JoystickController::init()
 {
-    pinMode(BUTTON_PIN, INPUT_PULLUP);
-    button.previousValue = HIGH;
-    button.previousTs = millis();
+    Button::begin();
 }
 
-JoystickController::Press JoystickController::getButtonValue(const u32 currentTs)
+ISR(INT0_vect) { JoystickController::Button::capture(); }
+
+JoystickController::Press JoystickController::getButtonValue()
 {
     /* Button thresholds */
     static constexpr u32 SHORT_PRESS_DUR = 50;
     static constexpr u32 LONG_PRESS_DURATION = 2000;
 
-    const bool changed = updateButton(currentTs);
-    if (!changed || !button.previousValue || button.pressDur < SHORT_PRESS_DUR)
+    /* Timed by the button's interrupt (see `Button`), not by when this gets called */
+    u32 pressDurUs;
+    if (!Button::nextPress(pressDurUs))
+        return Press::None;
+
+    const auto pressDur = pressDurUs / 1000;
+    if (pressDur < SHORT_PRESS_DUR)
         return Press::None;
-    return Press(u8(Press::Short) + (button.pressDur > LONG_PRESS_DURATION));
+    return Press(u8(Press::Short) + (pressDur > LONG_PRESS_DURATION));
 }
 
 JoystickController::Direction JoystickController::getDirection()
 {
+    const Zones::Scope scope(getDirectionZone);
+
     /* Axis thresholds */
     static constexpr Tiny::Pair<u16, u16> INPUT_RANGE = {
         0,
@@ -79,17 +89,3 @@ JoystickController::Direction JoystickController::getDirection()
         UNREACHABLE;
     }
 }
-
-bool JoystickController::updateButton(const u32 currentTs)
-{
-    const bool currentValue = digitalRead(BUTTON_PIN);
-    if (currentValue != button.previousValue) {
-        button.previousValue = currentValue;
-        button.pressDur = currentTs - button.previousTs;
-        button.previousTs = currentTs;
-
-        return true;
-    }
-
-    return false;
-}
@@ -1,4 +1,5 @@
 #pragma once
+#include "common/button.h"
 #include "utils.h"
 #include <Arduino.h>
 
@@ -23,22 +24,15 @@ public:
     };
 
     void init();
-    Press getButtonValue(u32 currentTs);
+    Press getButtonValue();
     Direction getDirection();
 
     static constexpr u8 BUTTON_PIN = 2;
+    using Button = ::Button<BUTTON_PIN>;
     static constexpr u8 X_AXIS_PIN = A0;
     static constexpr u8 Y_AXIS_PIN = A1;
     static constexpr auto NUM_DIRECTIONS = u8(Direction::NumDirections);
 
 private:
-    bool updateButton(u32 currentTs);
-
-private:
-    struct {
-        bool previousValue;
-        u32 previousTs;
-        u32 pressDur;
-    } button;
     MoveState moveState;
 };
@@ -1,22 +1,38 @@
 #include "DisplayController.h"
+#include "common/bench.h"
+#include "common/console.h"
+#include "common/scheduler.h"
 
 /* Global variables */
 static JoystickController joystickController;
-static DisplayController displayController;
 
 /* Functions */
+static void update() { displayController.update(millis(), joystickController); }
+
+/* The display is refreshed from its own interrupt, this only handles input and the blinking */
+using Tasks = Scheduler::Tasks<Scheduler::Task<update, 10>>;
+
 void setup()
 {
+    Console::begin();
     displayController.init();
     joystickController.init();
+    Tasks::begin();
 }
 
-void loop() { displayController.update(millis(), joystickController); }
+void loop()
+{
+    if (!Tasks::dispatch())
+        Tasks::idle();
+}
 
 int main()
 {
     init();
     setup();
-    for (;;)
+    for (;;) {
+        Bench::markLoop();
         loop();
+        Console::poll();
+    }
 }
@@ -1,4 +1,7 @@
 #include "DisplayController.h"
+#include "common/boot.h"
+#include "common/log.h"
+#include "common/zones.h"
 
 using State = DisplayController::State;
 
@@ -23,10 +26,23 @@ static constexpr Tiny::Pair<void*, u16> SETTINGS_FROM_STORAGE[] = {
     { &displayController.brightness, sizeof(displayController.brightness) },
 };
 static constexpr State DEFAULT_MENU_STATE
-    = { &mainMenuUpdate, 0, true, { .mainMenu = { 0 } } };
+    = { &mainMenuUpdate, 0, true, { .mainMenu = { 0 } }, {} };
+
+ZONE(updateZone, "DisplayController::update");
+ZONE(greetZone, "greetUpdate");
+ZONE(gameOverZone, "gameOverUpdate");
+ZONE(mainMenuZone, "mainMenuUpdate");
+ZONE(startGameZone, "startGameUpdate");
+ZONE(settingsZone, "settingsUpdate");
+ZONE(aboutZone, "aboutUpdate");
+ZONE(sliderZone, "sliderUpdate");
+ZONE(eepromReadZone, "eepromRead");
+ZONE(eepromWriteZone, "eepromWrite");
 
 static void eepromRead(void* addr, size_t eepromBaseAddr, size_t count)
 {
+    const Zones::Scope scope(eepromReadZone);
+
     u8 buffer[count];
 
     for (size_t i = 0; i < count; ++i)
@@ -37,6 +53,8 @@ static void eepromRead(void* addr, size_t eepromBaseAddr, size_t count)
 
 static void eepromWrite(const void* addr, size_t eepromBaseAddr, size_t count)
 {
+    const Zones::Scope scope(eepromWriteZone);
+
     u8 buffer[count];
     memcpy(&buffer[0], addr, count);
 
@@ -54,49 +72,57 @@ void refreshBrightness(const void* data)
     analogWrite(DisplayController::BRIGHTNESS_PIN, int(*(const i32*)(data)));
 }
 
-void greetUpdate(u32 currentTs, JoystickController::Press, JoystickController::Direction)
+void greetUpdate(
+    u32 currentTs, JoystickController::Press joyPress, JoystickController::Direction joyDir)
 {
+    const Zones::Scope scope(greetZone);
+
     static constexpr u32 DURATION = 5000;
 
     auto& lcd = displayController.lcd;
     auto& state = displayController.state;
 
-    if (state.entry) {
-        state.entry = false;
-
-        lcd.clear();
-        lcd.print("HAVE FUN!");
+    /* Any input skips the greeting */
+    if (joyPress != JoystickController::Press::None
+        || joyDir != JoystickController::Direction::None) {
+        state = DEFAULT_MENU_STATE;
+        return;
     }
 
-    if (currentTs - state.timestamp > DURATION)
-        state = DEFAULT_MENU_STATE;
+    CO_BEGIN(state.co);
+    lcd.clear();
+    lcd.print("HAVE FUN!");
+    CO_SLEEP(state.co, currentTs, DURATION);
+    state = DEFAULT_MENU_STATE;
+    CO_END(state.co);
 }
 
 void gameOverUpdate(u32 currentTs, JoystickController::Press, JoystickController::Direction)
 {
+    const Zones::Scope scope(gameOverZone);
+
     static constexpr u32 DURATION = 5000;
 
     auto& lcd = displayController.lcd;
     auto& state = displayController.state;
     auto& params = displayController.state.params.gameOver;
 
-    if (state.entry) {
-        state.entry = false;
-
-        lcd.clear();
-        lcd.print("GAME OVER");
-        lcd.setCursor(0, 1);
-        lcd.print("SCORE: ");
-        lcd.print(params.score);
-    }
-
-    if (currentTs - state.timestamp > DURATION)
-        state = DEFAULT_MENU_STATE;
+    CO_BEGIN(state.co);
+    lcd.clear();
+    lcd.print("GAME OVER");
+    lcd.setCursor(0, 1);
+    lcd.print("SCORE: ");
+    lcd.print(params.score);
+    CO_SLEEP(state.co, currentTs, DURATION);
+    state = DEFAULT_MENU_STATE;
+    CO_END(state.co);
 }
 
 void mainMenuUpdate(
     u32 currentTs, JoystickController::Press, JoystickController::Direction joyDir)
 {
+    const Zones::Scope scope(mainMenuZone);
+
     enum MenuPosition : u8 {
         StartGame = 0,
         Settings,
@@ -120,18 +146,21 @@ void mainMenuUpdate(
                     { 0, 0 },
                     255
                 }
-            }
+            },
+            {}
         },
         [Settings] = {
             &settingsUpdate,
             0,
             true,
+            {},
             {}
         },
         [About] = {
             &aboutUpdate,
             0,
             true,
+            {},
             {}
         },
     };
@@ -170,15 +199,17 @@ void mainMenuUpdate(
 void startGameUpdate(
     u32 currentTs, JoystickController::Press, JoystickController::Direction joyDir)
 {
+    const Zones::Scope scope(startGameZone);
+
     auto& lcd = displayController.lcd;
-    auto& lc = displayController.lc;
     auto& state = displayController.state;
     auto& params = displayController.state.params.game;
 
     if (state.entry) {
         state.entry = false;
 
-        randomSeed(micros());
+        /* Unpredictable for the player, but reproduced when replaying a trace */
+        randomSeed(state.timestamp);
 
         lcd.clear();
         lcd.print("PLAYING");
@@ -186,7 +217,7 @@ void startGameUpdate(
         lcd.print(params.score);
         lcd.print("  ");
 
-        lc.setLed(0, params.player.y, params.player.x, true);
+        displayController.setPixel(params.player, true);
     }
 
     const auto oldPos = params.player;
@@ -210,8 +241,9 @@ void startGameUpdate(
     }
 
     if (params.player != oldPos) {
-        lc.setLed(0, oldPos.y, oldPos.x, false);
-        lc.setLed(0, params.player.y, params.player.x, true);
+        displayController.setPixel(oldPos, false);
+        displayController.setPixel(params.player, true);
+        LOG("player moved to {i8} {i8}", params.player.x, params.player.y);
     }
 
     if (params.player == params.food) {
@@ -223,18 +255,20 @@ void startGameUpdate(
 
         while (params.food == params.player)
             params.food = {
-                i8(random(DisplayController::MATRIX_SIZE)),
-                i8(random(DisplayController::MATRIX_SIZE)),
+                i8(random(DisplayController::PLAYFIELD_WIDTH)),
+                i8(random(DisplayController::PLAYFIELD_HEIGHT)),
             };
 
-        lc.setLed(0, params.food.y, params.food.x, true);
+        displayController.setPixel(params.food, true);
+        LOG("score {u8}, food at {i8} {i8}", params.score, params.food.x, params.food.y);
     }
 
-    if(params.player != params.player.clamp(0, DisplayController::MATRIX_SIZE - 1)) {
-        lc.clearDisplay(0);
+    if (!DisplayController::onPlayfield(params.player)) {
+        displayController.clearFrame();
+        LOG("game over after {u32} ms, score {u8}", currentTs - state.timestamp, params.score);
 
         const auto score = params.score;
-        state = { gameOverUpdate, currentTs, true, {} };
+        state = { gameOverUpdate, currentTs, true, {}, {} };
         state.params.gameOver.score
             = score; /* Separately, otherwise internal compiler error */
     }
@@ -242,6 +276,8 @@ void startGameUpdate(
 
 void settingsUpdate(u32, JoystickController::Press, JoystickController::Direction joyDir)
 {
+    const Zones::Scope scope(settingsZone);
+
     enum SettingsPosition : u8 {
         Contrast = 0,
         Brightness,
@@ -265,7 +301,8 @@ void settingsUpdate(u32, JoystickController::Press, JoystickController::Directio
                     255,
                     &refreshContrast
                 }
-            }
+            },
+            {}
         },
         [Brightness] = {
             &sliderUpdate,
@@ -279,7 +316,8 @@ void settingsUpdate(u32, JoystickController::Press, JoystickController::Directio
                     255,
                     &refreshBrightness
                 }
-            }
+            },
+            {}
         },
     };
 
@@ -322,27 +360,28 @@ void settingsUpdate(u32, JoystickController::Press, JoystickController::Directio
 
 void aboutUpdate(u32 currentTs, JoystickController::Press, JoystickController::Direction)
 {
+    const Zones::Scope scope(aboutZone);
+
     static constexpr u32 DURATION = 3000;
 
     auto& lcd = displayController.lcd;
     auto& state = displayController.state;
 
-    if (state.entry) {
-        state.entry = false;
-
-        lcd.clear();
-        lcd.print("QUASI-SNAKE");
-        lcd.setCursor(0, 1);
-        lcd.print("Nicula Ionut 334");
-    }
-
-    if (currentTs - state.timestamp > DURATION)
-        state = DEFAULT_MENU_STATE;
+    CO_BEGIN(state.co);
+    lcd.clear();
+    lcd.print("QUASI-SNAKE");
+    lcd.setCursor(0, 1);
+    lcd.print("Nicula Ionut 334");
+    CO_SLEEP(state.co, currentTs, DURATION);
+    state = DEFAULT_MENU_STATE;
+    CO_END(state.co);
 }
 
 template <i32 DIFF>
 void sliderUpdate(u32, JoystickController::Press, JoystickController::Direction joyDir)
 {
+    const Zones::Scope scope(sliderZone);
+
     auto& lcd = displayController.lcd;
     auto& state = displayController.state;
     auto& params = displayController.state.params.slider;
@@ -373,15 +412,18 @@ void sliderUpdate(u32, JoystickController::Press, JoystickController::Direction
     }
 
     if (joyDir == JoystickController::Direction::Left)
-        state = { &settingsUpdate, 0, true, {} };
+        state = { &settingsUpdate, 0, true, {}, {} };
 }
 
 DisplayController::DisplayController()
-    : lcd(RS_PIN, ENABLE_PIN, D4, D5, D6, D7)
-    , lc(DIN_PIN, CLOCK_PIN, LOAD_PIN, 1)
+    : lcd(panel)
 {
 }
 
+/*
+ *  Only what the first input needs is done here: the settings, the matrix (a few bytes over
+ *  SPI) and the backlight. The LCD comes up from its interrupt in the background.
+ */
 void DisplayController::init()
 {
     size_t eepromAddr = 0;
@@ -390,21 +432,80 @@ void DisplayController::init()
         eepromAddr += pair.second;
     }
 
-    lc.shutdown(0, false);
-    lc.setIntensity(0, DEFAULT_MATRIX_BRIGHTNESS);
-    lc.clearDisplay(0);
+    matrix.begin();
+    for (u8 device = 0; device < NUM_MATRICES; ++device) {
+        matrix.shutdown(device, false);
+        matrix.setIntensity(device, DEFAULT_MATRIX_BRIGHTNESS);
+    }
 
-    lcd.begin(NUM_COLS, NUM_ROWS);
+    Panel::begin(NUM_ROWS);
     pinMode(CONTRAST_PIN, OUTPUT);
     pinMode(BRIGHTNESS_PIN, OUTPUT);
     analogWrite(CONTRAST_PIN, i16(contrast));
     analogWrite(BRIGHTNESS_PIN, i16(brightness));
 
-    state = { greetUpdate, millis(), true, {} };
+    state = { greetUpdate, millis(), true, {}, {} };
 }
 
+ISR(TIMER1_COMPA_vect) { DisplayController::Panel::drain(); }
+
 void DisplayController::update(
     u32 currentTs, JoystickController::Press joyPress, JoystickController::Direction joyDir)
 {
+    /* A coroutine state isn't called while it sleeps, unless there's input */
+    const bool input = joyPress != JoystickController::Press::None
+        || joyDir != JoystickController::Direction::None;
+    if (!input && state.co.sleeping(currentTs))
+        return;
+    /* The game over and about screens discard input, the greeting skips to the menu on it */
+    if (input && state.updateFunc != gameOverUpdate && state.updateFunc != aboutUpdate)
+        Boot::inputAccepted();
+
+    const Zones::Scope scope(updateZone);
+
     state.updateFunc(currentTs, joyPress, joyDir);
 }
+
+/* Sends the matrix and the LCD what changed since the last call */
+void DisplayController::draw()
+{
+    flushFrame();
+    lcd.commit();
+}
+
+bool DisplayController::onPlayfield(const Position pos)
+{
+    return pos.x >= 0 && pos.x < PLAYFIELD_WIDTH && pos.y >= 0 && pos.y < PLAYFIELD_HEIGHT;
+}
+
+void DisplayController::setPixel(const Position pos, const bool on)
+{
+    if (!onPlayfield(pos))
+        return;
+
+    const auto y = u8(pos.y);
+    auto& bits = frame[y][pos.x / MATRIX_SIZE];
+    const auto mask = u8(0x80 >> (pos.x % MATRIX_SIZE));
+    const auto row = on ? u8(bits | mask) : u8(bits & ~mask);
+    if (row != bits) {
+        bits = row;
+        dirtyRows = u8(dirtyRows | (1 << y));
+    }
+}
+
+void DisplayController::clearFrame()
+{
+    for (u8 y = 0; y < PLAYFIELD_HEIGHT; ++y)
+        for (auto& bits : frame[y])
+            if (bits) {
+                bits = 0;
+                dirtyRows = u8(dirtyRows | (1 << y));
+            }
+}
+
+void DisplayController::flushFrame()
+{
+    for (u8 y = 0; dirtyRows; ++y, dirtyRows = u8(dirtyRows >> 1))
+        if (dirtyRows & 1)
+            matrix.setRows(y, frame[y]);
+}
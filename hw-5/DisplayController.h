@@ -1,8 +1,15 @@
 #pragma once
 #include "EEPROM.h"
 #include "JoystickController.h"
-#include "LedControl.h"
-#include "LiquidCrystal.h"
+#include "common/coroutine.h"
+#include "common/hd44780.h"
+#include "common/lcdshadow.h"
+#include "common/max7219.h"
+
+/* Number of daisy-chained 8x8 matrices, side by side (`make MATRICES=N`) */
+#ifndef MATRICES
+#define MATRICES 1
+#endif
 
 using i8 = int8_t;
 using i16 = int16_t;
@@ -14,11 +21,6 @@ public:
     struct Position {
         bool operator==(const Position& rhs) const { return x == rhs.x && y == rhs.y; }
         bool operator!=(const Position& rhs) const { return !(*this == rhs); }
-        Position clamp(const i8 low, const i8 high) const
-        {
-            return { Tiny::clamp(x, low, high), Tiny::clamp(y, low, high) };
-        }
-
         i8 x, y;
     };
 
@@ -53,6 +55,7 @@ public:
             SettingSliderParams slider;
             GameOverParams gameOver;
         } params;
+        Coroutine co; /* For the states written as coroutines, reset by every transition */
     };
 
     DisplayController();
@@ -60,11 +63,30 @@ public:
     void init();
     void update(u32 currentTs, JoystickController::Press joyPress,
         JoystickController::Direction joyDir);
+    void draw();
+
+    /* Drawing goes to `frame`; the rows that changed are sent by `draw()` */
+    static bool onPlayfield(Position pos);
+    void setPixel(Position pos, bool on);
+    void clearFrame();
+    void flushFrame();
 
+#ifdef HARDWARE_SPI
+    static constexpr u8 DIN_PIN = Spi::MOSI_PIN;
+    static constexpr u8 CLOCK_PIN = Spi::SCK_PIN;
+    static constexpr u8 LOAD_PIN = Spi::SS_PIN;
+    using MatrixBus = Spi::Hardware<>;
+#else
     static constexpr u8 DIN_PIN = 12;
     static constexpr u8 CLOCK_PIN = 11;
     static constexpr u8 LOAD_PIN = 10;
+    using MatrixBus = Spi::BitBang<DIN_PIN, CLOCK_PIN>;
+#endif
     static constexpr u8 MATRIX_SIZE = 8;
+    static constexpr u8 NUM_MATRICES = MATRICES;
+    static constexpr u8 PLAYFIELD_WIDTH = MATRIX_SIZE * NUM_MATRICES;
+    static constexpr u8 PLAYFIELD_HEIGHT = MATRIX_SIZE;
+    using Matrix = Max7219<MatrixBus, LOAD_PIN, NUM_MATRICES>;
     static constexpr u8 RS_PIN = 9;
     static constexpr u8 ENABLE_PIN = 8;
     static constexpr u8 D4 = A2;
@@ -78,10 +100,16 @@ public:
     static constexpr u8 DEFAULT_CONTRAST = 90;
     static constexpr u8 DEFAULT_BRIGHTNESS = 255;
     static constexpr u8 DEFAULT_MATRIX_BRIGHTNESS = 255;
+    using Panel = Hd44780<RS_PIN, ENABLE_PIN, D4, D5, D6, D7>;
+    using Lcd = LcdShadow<Panel, NUM_COLS, NUM_ROWS>;
 
 public:
-    LiquidCrystal lcd;
-    LedControl lc;
+    Panel panel;
+    Lcd lcd; /* Committed to `panel` after each update */
+    Matrix matrix;
+    /* Pixel (x, y) is bit `7 - x % 8` of `frame[y][x / 8]`, as sent to matrix `x / 8` */
+    u8 frame[PLAYFIELD_HEIGHT][NUM_MATRICES];
+    u8 dirtyRows;
     State state;
     i32 contrast;
     i32 brightness;
@@ -1,22 +1,46 @@
 #include "JoystickController.h"
 
+JoystickController::Events JoystickController::events;
+
 void JoystickController::init()
 {
-    pinMode(BUTTON_PIN, INPUT_PULLUP);
-    button.previousValue = HIGH;
-    button.previousTs = millis();
+    Button::begin();
+    Axes::begin();
+
+    /*
+     *  Timer0 overflows every 1.024 ms for `millis()`, and compare B samples once per period
+     *  whatever `OCR0B` holds. `OCR0B` is the duty cycle of the brightness PWM on pin 5
+     *  (OC0B), so the sampling phase within the period follows the brightness setting.
+     */
+    TIMSK0 |= (1 << OCIE0B);
+}
+
+void JoystickController::sample()
+{
+    const auto press = getButtonValue();
+    const auto dir = getDirection();
+    if (u8(press) || u8(dir))
+        events.push({ millis(), press, dir });
 }
 
-JoystickController::Press JoystickController::getButtonValue(const u32 currentTs)
+ISR(INT0_vect) { JoystickController::Button::capture(); }
+ISR(ADC_vect) { JoystickController::Axes::drain(); }
+
+JoystickController::Press JoystickController::getButtonValue()
 {
     /* Button thresholds */
     static constexpr u32 SHORT_PRESS_DUR = 50;
     static constexpr u32 LONG_PRESS_DURATION = 2000;
 
-    const bool changed = updateButton(currentTs);
-    if (!changed || !button.previousValue || button.pressDur < SHORT_PRESS_DUR)
+    /* Timed by the button's interrupt (see `Button`), not by when this gets called */
+    u32 pressDurUs;
+    if (!Button::nextPress(pressDurUs))
         return Press::None;
-    return Press(u8(Press::Short) + (button.pressDur > LONG_PRESS_DURATION));
+
+    const auto pressDur = pressDurUs / 1000;
+    if (pressDur < SHORT_PRESS_DUR)
+        return Press::None;
+    return Press(u8(Press::Short) + (pressDur > LONG_PRESS_DURATION));
 }
 
 JoystickController::Direction JoystickController::getDirection()
@@ -41,8 +65,11 @@ JoystickController::Direction JoystickController::getDirection()
         INPUT_MIDDLE + NON_CONFLICT_DELTA_THRESHOLD,
     };
 
-    const auto xVal = u16(analogRead(X_AXIS_PIN));
-    const auto yVal = u16(analogRead(Y_AXIS_PIN));
+    /* Averaged in the background (see `Axes`), so this doesn't wait for the ADC */
+    u16 axes[Axes::NUM_PINS];
+    Axes::latest(axes);
+    const auto xVal = axes[0];
+    const auto yVal = axes[1];
 
     /*
      *  Only return a direction if an axis is past the minimum/maximum threshold and the other
@@ -79,17 +106,3 @@ JoystickController::Direction JoystickController::getDirection()
         UNREACHABLE;
     }
 }
-
-bool JoystickController::updateButton(const u32 currentTs)
-{
-    const bool currentValue = digitalRead(BUTTON_PIN);
-    if (currentValue != button.previousValue) {
-        button.previousValue = currentValue;
-        button.pressDur = currentTs - button.previousTs;
-        button.previousTs = currentTs;
-
-        return true;
-    }
-
-    return false;
-}
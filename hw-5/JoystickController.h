@@ -1,4 +1,7 @@
 #pragma once
+#include "common/adcscan.h"
+#include "common/button.h"
+#include "common/eventqueue.h"
 #include "utils.h"
 #include <Arduino.h>
 
@@ -21,24 +24,31 @@ public:
         Ok = 0,
         NeedsReset,
     };
+    struct Event {
+        u32 ts;
+        Press press;
+        Direction dir;
+    };
 
     void init();
-    Press getButtonValue(u32 currentTs);
-    Direction getDirection();
+
+    /* Queues the input since the last call, if any. Runs in the Timer0 compare B interrupt. */
+    void sample();
+    static bool nextEvent(Event& event) { return events.pop(event); }
+    static u16 droppedEvents() { return events.dropped(); }
 
     static constexpr u8 BUTTON_PIN = 2;
+    using Button = ::Button<BUTTON_PIN>;
     static constexpr u8 X_AXIS_PIN = A0;
     static constexpr u8 Y_AXIS_PIN = A1;
+    using Axes = AdcScan<8, X_AXIS_PIN, Y_AXIS_PIN>;
     static constexpr auto NUM_DIRECTIONS = u8(Direction::NumDirections);
 
 private:
-    bool updateButton(u32 currentTs);
+    Press getButtonValue();
+    Direction getDirection();
 
-private:
-    struct {
-        bool previousValue;
-        u32 previousTs;
-        u32 pressDur;
-    } button;
+    using Events = EventQueue<Event, 8>;
+    static Events events;
     MoveState moveState;
 };
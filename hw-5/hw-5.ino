@@ -1,30 +1,96 @@
 #include "Arduino.h"
 #include "DisplayController.h"
 #include "EEPROM.h"
-#include "LedControl.h"
-#include "LiquidCrystal.h"
+#include "common/bench.h"
+#include "common/console.h"
+#include "common/scheduler.h"
+#include "common/trace.h"
+#ifdef INSTRUMENT_REPLAY
+#include "replay.h" /* `REPLAY_TRACE`, see `tools/trace.py header` */
+#endif
+
+/* Of each task run, input and redraw alike; misses show up with `INSTRUMENTATION="LATENCY"` */
+static constexpr u32 LOOP_DEADLINE_US = 2000;
 
 static JoystickController joystickController;
 
+ISR(TIMER0_COMPB_vect) { joystickController.sample(); }
+
+/* Takes the next input event, recorded or replayed as set up in `common/trace.h` */
+static bool nextInput(const u32 currentTs, JoystickController::Event& event)
+{
+#ifdef INSTRUMENT_REPLAY
+    /* The joystick's own events are discarded */
+    while (JoystickController::nextEvent(event))
+        ;
+
+    event.ts = currentTs;
+    const auto input = Trace::replay(event.ts);
+    if (!input)
+        return false;
+    event.press = JoystickController::Press(input >> 4);
+    event.dir = JoystickController::Direction(input & 0x0F);
+#else
+    if (!JoystickController::nextEvent(event))
+        return false;
+#endif
+#ifdef INSTRUMENT_TRACE
+    Trace::record(event.ts, u8(u8(event.press) << 4 | u8(event.dir)));
+#endif
+    (void)currentTs;
+    return true;
+}
+
+/* Runs the state on every event sampled since the last run, then on the current time */
+static void runState()
+{
+    const Latency::Scope latency(Latency::Tag(displayController.state.updateFunc));
+
+    const auto currentTs = millis();
+    JoystickController::Event event;
+    while (nextInput(currentTs, event))
+        displayController.update(event.ts, event.press, event.dir);
+    displayController.update(
+        currentTs, JoystickController::Press::None, JoystickController::Direction::None);
+}
+
+/* The state whose screen it is takes the blame for a slow redraw */
+static void draw()
+{
+    const Latency::Scope latency(Latency::Tag(displayController.state.updateFunc));
+
+    displayController.draw();
+}
+
+/* Input is handled within 5 ms; the matrix and the LCD are redrawn at 50 Hz */
+using Tasks = Scheduler::Tasks<Scheduler::Task<runState, 5>, Scheduler::Task<draw, 20>>;
+
 void setup()
 {
+    Console::begin();
+    Latency::begin(LOOP_DEADLINE_US);
+#ifdef INSTRUMENT_REPLAY
+    Trace::beginReplay(REPLAY_TRACE, sizeof(REPLAY_TRACE));
+#endif
     joystickController.init();
     displayController.init();
+    Tasks::begin();
+    Boot::ready();
 }
 
 void loop()
 {
-    const auto currentTs = millis();
-    const auto joyPress = joystickController.getButtonValue(currentTs);
-    const auto joyDir = joystickController.getDirection();
-
-    displayController.update(currentTs, joyPress, joyDir);
+    if (!Tasks::dispatch())
+        Tasks::idle();
 }
 
 int main()
 {
     init();
     setup();
-    for (;;)
+    for (;;) {
+        Bench::markLoop();
         loop();
+        Console::poll();
+    }
 }
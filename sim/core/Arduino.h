@@ -0,0 +1,362 @@
+/*
+ *  Host-side stand-in for the Arduino core.
+ *
+ *  Only the subset used by the sketches is provided. Every call is charged a number of CPU
+ *  cycles on the simulator's virtual clock (see `Sim.h`), so `millis()`/`micros()` advance
+ *  as they would on a 16 MHz ATmega328P, but without ever sleeping on the host.
+ */
+
+#pragma once
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define F_CPU 16000000UL /* Given by the build for the board */
+
+/* Fixed-width aliases from the AVR core's `USBAPI.h` (`u32` is 32 bits wide on the AVR) */
+using u8 = uint8_t;
+using u16 = uint16_t;
+using u32 = uint32_t;
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define LSBFIRST 0
+#define MSBFIRST 1
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t*)(addr))
+#define pgm_read_ptr(addr) (*(void* const*)(addr))
+
+static constexpr uint8_t A0 = 14;
+static constexpr uint8_t A1 = 15;
+static constexpr uint8_t A2 = 16;
+static constexpr uint8_t A3 = 17;
+static constexpr uint8_t A4 = 18;
+static constexpr uint8_t A5 = 19;
+static constexpr uint8_t LED_BUILTIN = 13;
+static constexpr uint8_t NUM_DIGITAL_PINS = 20;
+static constexpr uint8_t NUM_ANALOG_INPUTS = 6;
+
+void init();
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+u32 millis();
+u32 micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void shiftOut(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder, uint8_t value);
+void tone(uint8_t pin, unsigned int frequency, unsigned long duration = 0);
+void noTone(uint8_t pin);
+long random(long howBig);
+long random(long howSmall, long howBig);
+void randomSeed(unsigned long seed);
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+
+/*
+ *  I/O port registers of the ATmega328P, mapped onto the simulated pins: port B is pins 8-13,
+ *  port C pins A0-A5 and port D pins 0-7. Each access costs a cycle.
+ */
+class PortRegister {
+public:
+    enum class Kind : uint8_t {
+        Pin = 0, /* Reads the input levels, writing 1s toggles the outputs */
+        Ddr,
+        Port,
+    };
+
+    constexpr PortRegister(const uint8_t firstPin, const uint8_t numPins, const Kind kind)
+        : firstPin(firstPin)
+        , numPins(numPins)
+        , kind(kind)
+    {
+    }
+
+    operator uint8_t() const;
+    PortRegister& operator=(uint8_t value);
+    PortRegister& operator|=(const uint8_t value) { return *this = uint8_t(*this | value); }
+    PortRegister& operator&=(const uint8_t value) { return *this = uint8_t(*this & value); }
+    PortRegister& operator^=(const uint8_t value) { return *this = uint8_t(*this ^ value); }
+
+private:
+    uint8_t firstPin;
+    uint8_t numPins;
+    Kind kind;
+};
+
+extern PortRegister PINB, DDRB, PORTB;
+extern PortRegister PINC, DDRC, PORTC;
+extern PortRegister PIND, DDRD, PORTD;
+
+/*
+ *  SPI peripheral: writing `SPDR` sends a byte (counted by `Sim::spiBytes()`), taking as many
+ *  cycles as the clock set in `SPCR`/`SPSR`, and sets `SPIF`. Only master mode is simulated.
+ */
+enum : uint8_t {
+    SPR0 = 0,
+    SPR1,
+    CPHA,
+    CPOL,
+    MSTR,
+    DORD,
+    SPE,
+    SPIE,
+};
+enum : uint8_t {
+    SPI2X = 0,
+    WCOL = 6,
+    SPIF,
+};
+
+class SpiDataRegister {
+public:
+    operator uint8_t() const { return 0; }
+    SpiDataRegister& operator=(uint8_t value);
+};
+
+extern uint8_t SPCR;
+extern uint8_t SPSR;
+extern SpiDataRegister SPDR;
+
+/* Interrupt flags: set by the simulated peripheral, cleared by writing a one to them */
+class InterruptFlagRegister {
+public:
+    operator uint8_t() const { return bits; }
+    InterruptFlagRegister& operator=(const uint8_t value)
+    {
+        bits = uint8_t(bits & ~value);
+        return *this;
+    }
+
+    uint8_t bits;
+};
+
+/*
+ *  Timer0, as the Arduino core sets it up for `millis()` (clk/64, overflowing every 1.024 ms),
+ *  with the compare B interrupt. The counter and the PWM outputs aren't simulated, but
+ *  `analogWrite()` on pins 5 and 6 sets `OCR0B` and `OCR0A` as on the board.
+ */
+enum : uint8_t {
+    OCIE0A = 1,
+    OCIE0B,
+};
+enum : uint8_t {
+    OCF0A = 1,
+    OCF0B,
+};
+
+extern uint8_t OCR0A;
+extern uint8_t OCR0B;
+extern uint8_t TIMSK0;
+extern InterruptFlagRegister TIFR0;
+
+/*
+ *  Timer2's registers, which `common/music.h`, `common/synth.h` and the profiler set up.
+ *  Nothing of Timer2 is simulated.
+ */
+enum : uint8_t {
+    WGM20 = 0,
+    WGM21,
+    COM2B0 = 4,
+    COM2B1,
+    COM2A0,
+    COM2A1,
+};
+enum : uint8_t {
+    CS20 = 0,
+    CS21,
+    CS22,
+};
+enum : uint8_t {
+    OCIE2A = 1,
+};
+
+extern uint8_t TCCR2A;
+extern uint8_t TCCR2B;
+extern uint8_t TCNT2;
+extern uint8_t OCR2A;
+extern uint8_t OCR2B;
+extern uint8_t TIMSK2;
+
+/*
+ *  Timer1, in the only mode the sketches use (normal mode, clk/8, see `common/zones.h`), with
+ *  the compare A interrupt. Compare B, which `common/synth.h` samples on, isn't simulated.
+ */
+enum : uint8_t {
+    CS10 = 0,
+    CS11,
+    CS12,
+};
+enum : uint8_t {
+    OCIE1A = 1,
+    OCIE1B,
+};
+enum : uint8_t {
+    OCF1A = 1,
+    OCF1B,
+};
+
+class Timer1Counter {
+public:
+    operator uint16_t() const;
+};
+
+extern uint8_t TCCR1A;
+extern uint8_t TCCR1B;
+extern uint8_t TIMSK1;
+extern InterruptFlagRegister TIFR1;
+extern uint16_t OCR1A;
+extern uint16_t OCR1B;
+extern Timer1Counter TCNT1;
+
+/*
+ *  ADC, converting the simulated analog inputs in single conversion mode (auto triggering
+ *  isn't simulated), with the conversion complete interrupt.
+ */
+enum : uint8_t {
+    ADPS0 = 0,
+    ADPS1,
+    ADPS2,
+    ADIE,
+    ADIF,
+    ADATE,
+    ADSC,
+    ADEN,
+};
+enum : uint8_t {
+    MUX0 = 0,
+    ADLAR = 5,
+    REFS0,
+    REFS1,
+};
+
+class AdcControlRegister {
+public:
+    operator uint8_t() const { return bits; }
+    AdcControlRegister& operator=(uint8_t value);
+    AdcControlRegister& operator|=(const uint8_t value)
+    {
+        return *this = uint8_t(bits | value);
+    }
+    AdcControlRegister& operator&=(const uint8_t value)
+    {
+        return *this = uint8_t(bits & value);
+    }
+
+    uint8_t bits;
+};
+
+extern uint8_t ADMUX;
+extern uint8_t ADCSRB;
+extern AdcControlRegister ADCSRA;
+extern uint16_t ADC;
+
+/*
+ *  External interrupts on pins 2 (INT0) and 3 (INT1), raised by `Sim::setDigitalInput()` on
+ *  the edges selected in `EICRA` (the low level mode isn't simulated).
+ */
+enum : uint8_t {
+    ISC00 = 0,
+    ISC01,
+    ISC10,
+    ISC11,
+};
+enum : uint8_t {
+    INT0 = 0,
+    INT1,
+};
+enum : uint8_t {
+    INTF0 = 0,
+    INTF1,
+};
+
+extern uint8_t EICRA;
+extern uint8_t EIMSK;
+extern InterruptFlagRegister EIFR;
+
+/*
+ *  Interrupts: `INT0_vect`, `INT1_vect`, `TIMER1_COMPA_vect`, `TIMER0_COMPB_vect` and
+ *  `ADC_vect` are simulated. A handler runs when the virtual clock passes its event, as long
+ *  as the I flag of `SREG` is set; otherwise its flag stays pending until the I flag is set
+ *  again and the clock next advances. Pending handlers run in the chip's vector order.
+ */
+#define ISR(vector) extern "C" void vector()
+extern "C" void INT0_vect();
+extern "C" void INT1_vect();
+extern "C" void TIMER1_COMPA_vect();
+extern "C" void TIMER0_COMPB_vect();
+extern "C" void ADC_vect();
+
+static constexpr uint8_t SREG_I = 0x80;
+extern uint8_t SREG;
+inline void cli() { SREG = uint8_t(SREG & ~SREG_I); }
+inline void sei() { SREG = uint8_t(SREG | SREG_I); }
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+
+class Print {
+public:
+    virtual ~Print() = default;
+    virtual size_t write(uint8_t) = 0;
+
+    size_t write(const char* str) { return write((const uint8_t*)str, strlen(str)); }
+    size_t write(const uint8_t* buffer, size_t size);
+
+    size_t print(const __FlashStringHelper* str) { return print((const char*)str); }
+    size_t print(const char* str) { return write(str); }
+    size_t print(char c) { return write(uint8_t(c)); }
+    size_t print(unsigned char n, int base = DEC) { return print((unsigned long)n, base); }
+    size_t print(int n, int base = DEC) { return print((long)n, base); }
+    size_t print(unsigned int n, int base = DEC) { return print((unsigned long)n, base); }
+    size_t print(long n, int base = DEC);
+    size_t print(unsigned long n, int base = DEC);
+    size_t print(double n, int digits = 2);
+
+    size_t println() { return write("\r\n"); }
+    template <typename T> size_t println(const T& value)
+    {
+        const auto n = print(value);
+        return n + println();
+    }
+    template <typename T> size_t println(const T& value, int format)
+    {
+        const auto n = print(value, format);
+        return n + println();
+    }
+
+private:
+    size_t printNumber(unsigned long n, uint8_t base);
+};
+
+class HardwareSerial : public Print {
+public:
+    void begin(unsigned long baud);
+    void end() { }
+    int available();
+    int read();
+    int availableForWrite();
+    void flush();
+    size_t write(uint8_t) override;
+    using Print::write;
+    explicit operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
@@ -0,0 +1,21 @@
+/*
+ *  Host-side stand-in for the `EEPROM` library (1 KiB, like the ATmega328P).
+ */
+
+#pragma once
+#include "Arduino.h"
+
+class EEPROMClass {
+public:
+    EEPROMClass();
+
+    uint8_t read(int addr);
+    void write(int addr, uint8_t value);
+    void update(int addr, uint8_t value);
+    uint16_t length() const { return sizeof(cells); }
+
+private:
+    uint8_t cells[1024];
+};
+
+extern EEPROMClass EEPROM;
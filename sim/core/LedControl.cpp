@@ -0,0 +1,111 @@
+#include "LedControl.h"
+
+/* MAX7219 register addresses */
+static constexpr uint8_t OP_DIGIT0 = 1;
+static constexpr uint8_t OP_DECODEMODE = 9;
+static constexpr uint8_t OP_INTENSITY = 10;
+static constexpr uint8_t OP_SCANLIMIT = 11;
+static constexpr uint8_t OP_SHUTDOWN = 12;
+static constexpr uint8_t OP_DISPLAYTEST = 15;
+
+LedControl::LedControl(const int dataPin, const int clkPin, const int csPin, int numDevices)
+    : spidata {}
+    , status {}
+    , SPI_MOSI(dataPin)
+    , SPI_CLK(clkPin)
+    , SPI_CS(csPin)
+{
+    if (numDevices <= 0 || numDevices > 8)
+        numDevices = 8;
+    maxDevices = numDevices;
+
+    pinMode(uint8_t(SPI_MOSI), OUTPUT);
+    pinMode(uint8_t(SPI_CLK), OUTPUT);
+    pinMode(uint8_t(SPI_CS), OUTPUT);
+    digitalWrite(uint8_t(SPI_CS), HIGH);
+
+    for (int i = 0; i < maxDevices; ++i) {
+        spiTransfer(i, OP_DISPLAYTEST, 0);
+        setScanLimit(i, 7);
+        spiTransfer(i, OP_DECODEMODE, 0);
+        clearDisplay(i);
+        shutdown(i, true);
+    }
+}
+
+void LedControl::shutdown(const int addr, const bool status)
+{
+    if (addr >= 0 && addr < maxDevices)
+        spiTransfer(addr, OP_SHUTDOWN, !status);
+}
+
+void LedControl::setScanLimit(const int addr, const int limit)
+{
+    if (addr >= 0 && addr < maxDevices && limit >= 0 && limit < 8)
+        spiTransfer(addr, OP_SCANLIMIT, uint8_t(limit));
+}
+
+void LedControl::setIntensity(const int addr, const int intensity)
+{
+    if (addr >= 0 && addr < maxDevices && intensity >= 0 && intensity < 16)
+        spiTransfer(addr, OP_INTENSITY, uint8_t(intensity));
+}
+
+void LedControl::clearDisplay(const int addr)
+{
+    if (addr < 0 || addr >= maxDevices)
+        return;
+
+    for (int i = 0; i < 8; ++i) {
+        status[addr * 8 + i] = 0;
+        spiTransfer(addr, uint8_t(OP_DIGIT0 + i), 0);
+    }
+}
+
+void LedControl::setLed(const int addr, const int row, const int column, const bool state)
+{
+    if (addr < 0 || addr >= maxDevices || row < 0 || row > 7 || column < 0 || column > 7)
+        return;
+
+    const auto offset = addr * 8 + row;
+    const auto value = uint8_t(0x80 >> column);
+    if (state)
+        status[offset] = uint8_t(status[offset] | value);
+    else
+        status[offset] = uint8_t(status[offset] & ~value);
+    spiTransfer(addr, uint8_t(OP_DIGIT0 + row), status[offset]);
+}
+
+void LedControl::setRow(const int addr, const int row, const uint8_t value)
+{
+    if (addr < 0 || addr >= maxDevices || row < 0 || row > 7)
+        return;
+
+    status[addr * 8 + row] = value;
+    spiTransfer(addr, uint8_t(OP_DIGIT0 + row), value);
+}
+
+void LedControl::setColumn(const int addr, const int col, const uint8_t value)
+{
+    if (addr < 0 || addr >= maxDevices || col < 0 || col > 7)
+        return;
+
+    for (int row = 0; row < 8; ++row)
+        setLed(addr, row, col, (value >> (7 - row)) & 0x01);
+}
+
+void LedControl::spiTransfer(const int addr, const uint8_t opcode, const uint8_t data)
+{
+    const auto offset = addr * 2;
+    const auto maxBytes = maxDevices * 2;
+
+    for (int i = 0; i < maxBytes; ++i)
+        spidata[i] = 0;
+    spidata[offset + 1] = opcode;
+    spidata[offset] = data;
+
+    digitalWrite(uint8_t(SPI_CS), LOW);
+    for (int i = maxBytes; i > 0; --i)
+        shiftOut(uint8_t(SPI_MOSI), uint8_t(SPI_CLK), MSBFIRST, spidata[i - 1]);
+    digitalWrite(uint8_t(SPI_CS), HIGH);
+}
@@ -0,0 +1,35 @@
+/*
+ *  Host-side stand-in for the `LedControl` library (MAX7219/MAX7221). Register writes are
+ *  bit-banged with `shiftOut`, like in the original library.
+ */
+
+#pragma once
+#include "Arduino.h"
+
+class LedControl {
+public:
+    LedControl(int dataPin, int clkPin, int csPin, int numDevices = 1);
+
+    int getDeviceCount() const { return maxDevices; }
+    void shutdown(int addr, bool status);
+    void setScanLimit(int addr, int limit);
+    void setIntensity(int addr, int intensity);
+    void clearDisplay(int addr);
+    void setLed(int addr, int row, int col, bool state);
+    void setRow(int addr, int row, uint8_t value);
+    void setColumn(int addr, int col, uint8_t value);
+
+    /* Simulator-only: the row registers as last latched by device `addr` */
+    uint8_t row(int addr, int row) const { return status[addr * 8 + row]; }
+
+private:
+    void spiTransfer(int addr, uint8_t opcode, uint8_t data);
+
+private:
+    uint8_t spidata[16];
+    uint8_t status[64];
+    int SPI_MOSI;
+    int SPI_CLK;
+    int SPI_CS;
+    int maxDevices;
+};
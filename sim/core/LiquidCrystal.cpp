@@ -0,0 +1,122 @@
+#include "LiquidCrystal.h"
+
+/* HD44780 instruction set (the subset used by the original library) */
+static constexpr uint8_t LCD_CLEARDISPLAY = 0x01;
+static constexpr uint8_t LCD_RETURNHOME = 0x02;
+static constexpr uint8_t LCD_ENTRYMODESET = 0x04;
+static constexpr uint8_t LCD_DISPLAYCONTROL = 0x08;
+static constexpr uint8_t LCD_FUNCTIONSET = 0x20;
+static constexpr uint8_t LCD_SETDDRAMADDR = 0x80;
+static constexpr uint8_t LCD_ENTRYLEFT = 0x02;
+static constexpr uint8_t LCD_DISPLAYON = 0x04;
+static constexpr uint8_t LCD_2LINE = 0x08;
+static constexpr uint8_t ROW_OFFSETS[2] = { 0x00, 0x40 };
+
+LiquidCrystal::LiquidCrystal(const uint8_t rs, const uint8_t enable, const uint8_t d0,
+    const uint8_t d1, const uint8_t d2, const uint8_t d3)
+    : rsPin(rs)
+    , enablePin(enable)
+    , dataPins { d0, d1, d2, d3 }
+    , numLines(1)
+    , address(0)
+{
+    begin(16, 1);
+}
+
+void LiquidCrystal::begin(const uint8_t, const uint8_t rows)
+{
+    numLines = rows;
+
+    pinMode(rsPin, OUTPUT);
+    pinMode(enablePin, OUTPUT);
+    for (auto pin : dataPins)
+        pinMode(pin, OUTPUT);
+
+    delayMicroseconds(50000);
+    digitalWrite(rsPin, LOW);
+    digitalWrite(enablePin, LOW);
+
+    /* 4-bit initialization sequence, see figure 24 of the HD44780 datasheet */
+    write4bits(0x03);
+    delayMicroseconds(4500);
+    write4bits(0x03);
+    delayMicroseconds(4500);
+    write4bits(0x03);
+    delayMicroseconds(150);
+    write4bits(0x02);
+
+    command(uint8_t(LCD_FUNCTIONSET | (rows > 1 ? LCD_2LINE : 0)));
+    command(LCD_DISPLAYCONTROL | LCD_DISPLAYON);
+    clear();
+    command(LCD_ENTRYMODESET | LCD_ENTRYLEFT);
+}
+
+void LiquidCrystal::clear()
+{
+    command(LCD_CLEARDISPLAY);
+    delayMicroseconds(2000);
+}
+
+void LiquidCrystal::home()
+{
+    command(LCD_RETURNHOME);
+    delayMicroseconds(2000);
+}
+
+void LiquidCrystal::setCursor(uint8_t col, uint8_t row)
+{
+    if (row >= numLines)
+        row = uint8_t(numLines - 1);
+    command(uint8_t(LCD_SETDDRAMADDR | (col + ROW_OFFSETS[row])));
+}
+
+void LiquidCrystal::command(const uint8_t value)
+{
+    send(value, LOW);
+
+    if (value == LCD_CLEARDISPLAY) {
+        memset(ddram, ' ', sizeof(ddram));
+        ddram[0][DDRAM_ROW_SIZE] = ddram[1][DDRAM_ROW_SIZE] = '\0';
+        address = 0;
+    } else if (value == LCD_RETURNHOME)
+        address = 0;
+    else if (value & LCD_SETDDRAMADDR)
+        address = uint8_t(value & ~LCD_SETDDRAMADDR);
+}
+
+size_t LiquidCrystal::write(const uint8_t value)
+{
+    send(value, HIGH);
+
+    const uint8_t row = address >= ROW_OFFSETS[1];
+    const uint8_t col = uint8_t(address - ROW_OFFSETS[row]);
+    if (col < DDRAM_ROW_SIZE)
+        ddram[row][col] = char(value);
+    address = uint8_t(ROW_OFFSETS[row] + (col + 1) % DDRAM_ROW_SIZE);
+
+    return 1;
+}
+
+void LiquidCrystal::send(const uint8_t value, const uint8_t mode)
+{
+    digitalWrite(rsPin, mode);
+    write4bits(uint8_t(value >> 4));
+    write4bits(value);
+}
+
+void LiquidCrystal::write4bits(const uint8_t value)
+{
+    for (uint8_t i = 0; i < 4; ++i)
+        digitalWrite(dataPins[i], (value >> i) & 0x01);
+    pulseEnable();
+}
+
+void LiquidCrystal::pulseEnable()
+{
+    digitalWrite(enablePin, LOW);
+    delayMicroseconds(1);
+    digitalWrite(enablePin, HIGH);
+    delayMicroseconds(1);
+    digitalWrite(enablePin, LOW);
+    delayMicroseconds(100); /* Commands need > 37 us to settle */
+}
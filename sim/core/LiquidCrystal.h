@@ -0,0 +1,39 @@
+/*
+ *  Host-side stand-in for the `LiquidCrystal` library (4-bit mode only). The bus protocol and
+ *  the settle delays are the same as in the original library, so the cost of every call is
+ *  charged to the virtual clock.
+ */
+
+#pragma once
+#include "Arduino.h"
+
+class LiquidCrystal : public Print {
+public:
+    LiquidCrystal(uint8_t rs, uint8_t enable, uint8_t d0, uint8_t d1, uint8_t d2, uint8_t d3);
+
+    void begin(uint8_t cols, uint8_t rows);
+    void clear();
+    void home();
+    void setCursor(uint8_t col, uint8_t row);
+    void command(uint8_t value);
+    size_t write(uint8_t value) override;
+    using Print::write;
+
+    /* Simulator-only: the characters currently shown on the panel */
+    const char* line(uint8_t row) const { return ddram[row]; }
+
+private:
+    void send(uint8_t value, uint8_t mode);
+    void write4bits(uint8_t value);
+    void pulseEnable();
+
+private:
+    static constexpr uint8_t DDRAM_ROW_SIZE = 40;
+
+    uint8_t rsPin;
+    uint8_t enablePin;
+    uint8_t dataPins[4];
+    uint8_t numLines;
+    uint8_t address;
+    char ddram[2][DDRAM_ROW_SIZE + 1];
+};
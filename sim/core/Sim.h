@@ -0,0 +1,28 @@
+/*
+ *  Control surface of the host simulator: the virtual clock and the external pin stimulus.
+ */
+
+#pragma once
+#include "Arduino.h"
+#include <stdio.h>
+
+namespace Sim {
+static constexpr uint64_t CPU_FREQUENCY = 16000000;
+static constexpr uint64_t CYCLES_PER_US = CPU_FREQUENCY / 1000000;
+static constexpr uint64_t CYCLES_PER_MS = CPU_FREQUENCY / 1000;
+
+/* Virtual clock, in CPU cycles since reset */
+uint64_t cycles();
+void advance(uint64_t numCycles);
+
+/* Stimulus and observation of the pins */
+void setDigitalInput(uint8_t pin, bool level);
+void setAnalogInput(uint8_t pin, uint16_t value);
+uint8_t digitalOutput(uint8_t pin);
+
+/* Bytes written to `Serial` go here (discarded if null) */
+void setSerialOutput(FILE* file);
+
+/* Number of bytes sent by the SPI peripheral */
+uint64_t spiBytes();
+}
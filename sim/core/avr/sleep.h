@@ -0,0 +1,15 @@
+/*
+ *  Sleep modes, of which only idle is simulated: `sleep_cpu()` moves the virtual clock to the
+ *  next interrupt that's enabled, or to the next millisecond (Timer0's overflow, behind
+ *  `millis()`), whichever comes first, and runs it.
+ */
+
+#pragma once
+#include "../Arduino.h"
+
+#define SLEEP_MODE_IDLE 0
+
+inline void set_sleep_mode(uint8_t) { }
+inline void sleep_enable() { }
+inline void sleep_disable() { }
+void sleep_cpu();
@@ -0,0 +1,594 @@
+#include "EEPROM.h"
+#include "LedControl.h"
+#include "LiquidCrystal.h"
+#include "Sim.h"
+#include "avr/sleep.h"
+
+/*
+ *  Approximate costs (in CPU cycles) of the Arduino core primitives on a 16 MHz ATmega328P.
+ *  Library code (`LiquidCrystal`, `LedControl`) is built on top of these, so its cost follows
+ *  from the calls it makes, like on the real chip.
+ */
+static constexpr uint64_t DIGITAL_IO_CYCLES = 50;
+static constexpr uint64_t PORT_IO_CYCLES = 1;
+static constexpr uint64_t ANALOG_READ_CYCLES = 112 * Sim::CYCLES_PER_US;
+static constexpr uint64_t ANALOG_WRITE_CYCLES = 60;
+static constexpr uint64_t TIME_READ_CYCLES = 30;
+static constexpr uint64_t SHIFT_OUT_BIT_CYCLES = 10;
+static constexpr uint64_t TONE_CYCLES = 400;
+static constexpr uint64_t RANDOM_CYCLES = 700;
+static constexpr uint64_t EEPROM_READ_CYCLES = 20;
+static constexpr uint64_t EEPROM_WRITE_CYCLES = 3400 * Sim::CYCLES_PER_US;
+static constexpr uint64_t SERIAL_TX_BUFFER_SIZE = 64;
+static constexpr uint64_t ISR_OVERHEAD_CYCLES = 20; /* Vectoring, prologue, epilogue, `reti` */
+static constexpr uint64_t TIMER0_TICK_CYCLES = 64;
+static constexpr uint64_t TIMER1_TICK_CYCLES = 8;
+
+static struct {
+    uint64_t cycles;
+    uint8_t mode[NUM_DIGITAL_PINS];
+    uint8_t output[NUM_DIGITAL_PINS];
+    bool input[NUM_DIGITAL_PINS];
+    bool inputDriven[NUM_DIGITAL_PINS];
+    uint16_t analog[NUM_ANALOG_INPUTS];
+    uint32_t randomState;
+    uint64_t serialCyclesPerByte;
+    uint64_t serialIdleAt;
+    FILE* serialOutput;
+    uint64_t spiBytes;
+    uint64_t adcDoneAt; /* End of the ongoing conversion, 0 if none */
+    bool adcStarted; /* Since the ADC was enabled */
+    uint64_t interrupts; /* Handlers run */
+} sim;
+
+HardwareSerial Serial;
+EEPROMClass EEPROM;
+
+PortRegister PINB(8, 6, PortRegister::Kind::Pin);
+PortRegister DDRB(8, 6, PortRegister::Kind::Ddr);
+PortRegister PORTB(8, 6, PortRegister::Kind::Port);
+PortRegister PINC(A0, 6, PortRegister::Kind::Pin);
+PortRegister DDRC(A0, 6, PortRegister::Kind::Ddr);
+PortRegister PORTC(A0, 6, PortRegister::Kind::Port);
+PortRegister PIND(0, 8, PortRegister::Kind::Pin);
+PortRegister DDRD(0, 8, PortRegister::Kind::Ddr);
+PortRegister PORTD(0, 8, PortRegister::Kind::Port);
+uint8_t SREG;
+uint8_t EICRA;
+uint8_t EIMSK;
+InterruptFlagRegister EIFR;
+uint8_t TCCR2A;
+uint8_t TCCR2B;
+uint8_t TCNT2;
+uint8_t OCR2A;
+uint8_t OCR2B;
+uint8_t TIMSK2;
+uint8_t TCCR1A;
+uint8_t TCCR1B;
+uint8_t TIMSK1;
+InterruptFlagRegister TIFR1;
+uint8_t OCR0A;
+uint8_t OCR0B;
+uint8_t TIMSK0;
+InterruptFlagRegister TIFR0;
+uint16_t OCR1A;
+uint16_t OCR1B;
+Timer1Counter TCNT1;
+uint8_t ADMUX;
+uint8_t ADCSRB;
+AdcControlRegister ADCSRA;
+uint16_t ADC;
+uint8_t SPCR;
+uint8_t SPSR;
+SpiDataRegister SPDR;
+
+static bool inputLevel(const uint8_t pin)
+{
+    if (sim.inputDriven[pin])
+        return sim.input[pin];
+    if (sim.mode[pin] == OUTPUT)
+        return sim.output[pin];
+    return sim.mode[pin] == INPUT_PULLUP;
+}
+
+uint64_t Sim::cycles() { return sim.cycles; }
+
+extern "C" __attribute__((weak)) void INT0_vect() { }
+extern "C" __attribute__((weak)) void INT1_vect() { }
+extern "C" __attribute__((weak)) void TIMER1_COMPA_vect() { }
+extern "C" __attribute__((weak)) void TIMER0_COMPB_vect() { }
+extern "C" __attribute__((weak)) void ADC_vect() { }
+
+static constexpr uint64_t NEVER = UINT64_MAX;
+
+/* Cycles until Timer0 next matches `OCR0B` (a full period if it just did) */
+static uint64_t cyclesToTimer0Match()
+{
+    const auto tick = sim.cycles / TIMER0_TICK_CYCLES;
+    auto ticks = uint64_t(uint8_t(OCR0B - uint8_t(tick)));
+    if (!ticks)
+        ticks = 0x100;
+    return (tick + ticks) * TIMER0_TICK_CYCLES - sim.cycles;
+}
+
+static bool timer1Running() { return TCCR1A == 0 && TCCR1B == (1 << CS11); }
+
+/* Cycles until Timer1 next matches `OCR1A` (a full period if it just did) */
+static uint64_t cyclesToCompareMatch()
+{
+    if (!timer1Running())
+        return NEVER;
+
+    const auto tick = sim.cycles / TIMER1_TICK_CYCLES;
+    auto ticks = uint64_t(uint16_t(OCR1A - uint16_t(tick)));
+    if (!ticks)
+        ticks = 0x10000;
+    return (tick + ticks) * TIMER1_TICK_CYCLES - sim.cycles;
+}
+
+static uint64_t cyclesToConversionEnd()
+{
+    return sim.adcDoneAt ? sim.adcDoneAt - sim.cycles : NEVER;
+}
+
+static void endConversion()
+{
+    const auto channel = ADMUX & 0x0F;
+    ADC = channel < NUM_ANALOG_INPUTS ? sim.analog[channel] : 0;
+    ADCSRA.bits = uint8_t((ADCSRA.bits & ~(1 << ADSC)) | (1 << ADIF));
+    sim.adcDoneAt = 0;
+}
+
+/* Runs the pending interrupts by vector priority, with the I flag cleared like on the chip */
+static void runInterrupts()
+{
+    while (SREG & SREG_I) {
+        void (*vector)();
+        if ((EIMSK & (1 << INT0)) && (EIFR & (1 << INTF0))) {
+            EIFR = (1 << INTF0);
+            vector = INT0_vect;
+        } else if ((EIMSK & (1 << INT1)) && (EIFR & (1 << INTF1))) {
+            EIFR = (1 << INTF1);
+            vector = INT1_vect;
+        } else if ((TIMSK1 & (1 << OCIE1A)) && (TIFR1 & (1 << OCF1A))) {
+            TIFR1 = (1 << OCF1A);
+            vector = TIMER1_COMPA_vect;
+        } else if ((TIMSK0 & (1 << OCIE0B)) && (TIFR0 & (1 << OCF0B))) {
+            TIFR0 = (1 << OCF0B);
+            vector = TIMER0_COMPB_vect;
+        } else if ((ADCSRA.bits & (1 << ADIE)) && (ADCSRA.bits & (1 << ADIF))) {
+            ADCSRA.bits = uint8_t(ADCSRA.bits & ~(1 << ADIF));
+            vector = ADC_vect;
+        } else
+            return;
+
+        cli();
+        ++sim.interrupts;
+        Sim::advance(ISR_OVERHEAD_CYCLES);
+        vector();
+        sei();
+    }
+}
+
+void Sim::advance(uint64_t numCycles)
+{
+    runInterrupts();
+
+    for (;;) {
+        const auto untilMatch = cyclesToCompareMatch();
+        const auto untilTimer0Match = cyclesToTimer0Match();
+        const auto untilConversionEnd = cyclesToConversionEnd();
+        auto untilEvent = untilMatch < untilConversionEnd ? untilMatch : untilConversionEnd;
+        if (untilTimer0Match < untilEvent)
+            untilEvent = untilTimer0Match;
+        if (untilEvent > numCycles)
+            break;
+
+        sim.cycles += untilEvent;
+        numCycles -= untilEvent;
+        if (untilEvent == untilTimer0Match)
+            TIFR0.bits = uint8_t(TIFR0.bits | (1 << OCF0B));
+        if (untilEvent == untilMatch)
+            TIFR1.bits = uint8_t(TIFR1.bits | (1 << OCF1A));
+        if (untilEvent == untilConversionEnd)
+            endConversion();
+        runInterrupts();
+    }
+    sim.cycles += numCycles;
+}
+
+/* Timer0's overflow always wakes the CPU up; the simulated `millis()` counts whole ms */
+void sleep_cpu()
+{
+    /* An interrupt that's already pending wakes it up right away */
+    const auto interrupts = sim.interrupts;
+    Sim::advance(0);
+    if (sim.interrupts != interrupts)
+        return;
+
+    auto untilWake = Sim::CYCLES_PER_MS - sim.cycles % Sim::CYCLES_PER_MS;
+    const auto untilMatch = TIMSK1 & (1 << OCIE1A) ? cyclesToCompareMatch() : NEVER;
+    const auto untilTimer0Match = TIMSK0 & (1 << OCIE0B) ? cyclesToTimer0Match() : NEVER;
+    const auto untilConversionEnd
+        = ADCSRA.bits & (1 << ADIE) ? cyclesToConversionEnd() : NEVER;
+    if (untilMatch < untilWake)
+        untilWake = untilMatch;
+    if (untilTimer0Match < untilWake)
+        untilWake = untilTimer0Match;
+    if (untilConversionEnd < untilWake)
+        untilWake = untilConversionEnd;
+    Sim::advance(untilWake);
+}
+
+void Sim::setDigitalInput(const uint8_t pin, const bool level)
+{
+    const bool previous = inputLevel(pin);
+    sim.input[pin] = level;
+    sim.inputDriven[pin] = true;
+
+    /* INT0 is pin 2 and INT1 pin 3; the handler runs the next time the clock advances */
+    if ((pin == 2 || pin == 3) && level != previous) {
+        const auto index = pin - 2;
+        const auto sense = (EICRA >> 2 * index) & 0x03;
+        if (sense == 0x01 || sense == (level ? 0x03 : 0x02))
+            EIFR.bits = uint8_t(EIFR.bits | (1 << (INTF0 + index)));
+    }
+}
+
+void Sim::setAnalogInput(const uint8_t pin, const uint16_t value)
+{
+    sim.analog[pin >= A0 ? pin - A0 : pin] = value;
+}
+
+uint8_t Sim::digitalOutput(const uint8_t pin) { return sim.output[pin]; }
+
+void Sim::setSerialOutput(FILE* file) { sim.serialOutput = file; }
+
+uint64_t Sim::spiBytes() { return sim.spiBytes; }
+
+/* Arduino core */
+void init()
+{
+    sim.randomState = 1;
+    sei();
+}
+
+void pinMode(const uint8_t pin, const uint8_t mode)
+{
+    Sim::advance(DIGITAL_IO_CYCLES);
+    sim.mode[pin] = mode;
+}
+
+void digitalWrite(const uint8_t pin, const uint8_t value)
+{
+    Sim::advance(DIGITAL_IO_CYCLES);
+    sim.output[pin] = value ? HIGH : LOW;
+}
+
+int digitalRead(const uint8_t pin)
+{
+    Sim::advance(DIGITAL_IO_CYCLES);
+    return inputLevel(pin) ? HIGH : LOW;
+}
+
+int analogRead(const uint8_t pin)
+{
+    Sim::advance(ANALOG_READ_CYCLES);
+    return sim.analog[pin >= A0 ? pin - A0 : pin];
+}
+
+void analogWrite(const uint8_t pin, const int value)
+{
+    Sim::advance(ANALOG_WRITE_CYCLES);
+    sim.output[pin] = value > 127 ? HIGH : LOW;
+    /* Timer0's PWM outputs, whose compare registers the interrupts share */
+    if (pin == 5)
+        OCR0B = uint8_t(value);
+    else if (pin == 6)
+        OCR0A = uint8_t(value);
+}
+
+PortRegister::operator uint8_t() const
+{
+    Sim::advance(PORT_IO_CYCLES);
+
+    uint8_t value = 0;
+    for (uint8_t i = 0; i < numPins; ++i) {
+        const auto pin = uint8_t(firstPin + i);
+        bool bit;
+        switch (kind) {
+        case Kind::Pin:
+            bit = inputLevel(pin);
+            break;
+        case Kind::Ddr:
+            bit = sim.mode[pin] == OUTPUT;
+            break;
+        default:
+            bit = sim.mode[pin] == OUTPUT ? sim.output[pin] : sim.mode[pin] == INPUT_PULLUP;
+            break;
+        }
+        value = uint8_t(value | bit << i);
+    }
+    return value;
+}
+
+PortRegister& PortRegister::operator=(const uint8_t value)
+{
+    Sim::advance(PORT_IO_CYCLES);
+
+    for (uint8_t i = 0; i < numPins; ++i) {
+        const auto pin = uint8_t(firstPin + i);
+        const bool bit = value & (1 << i);
+        const bool isOutput = sim.mode[pin] == OUTPUT;
+        switch (kind) {
+        case Kind::Pin:
+            if (bit && isOutput)
+                sim.output[pin] = !sim.output[pin];
+            else if (bit)
+                sim.mode[pin] = sim.mode[pin] == INPUT_PULLUP ? INPUT : INPUT_PULLUP;
+            break;
+        case Kind::Ddr:
+            if (bit)
+                sim.mode[pin] = OUTPUT;
+            else if (isOutput)
+                sim.mode[pin] = sim.output[pin] ? INPUT_PULLUP : INPUT;
+            break;
+        default:
+            if (isOutput)
+                sim.output[pin] = bit;
+            else
+                sim.mode[pin] = bit ? INPUT_PULLUP : INPUT;
+            break;
+        }
+    }
+    return *this;
+}
+
+SpiDataRegister& SpiDataRegister::operator=(const uint8_t)
+{
+    static constexpr uint8_t DIVIDERS[] = { 4, 16, 64, 128 };
+
+    Sim::advance(PORT_IO_CYCLES);
+    if (!(SPCR & (1 << SPE)))
+        return *this;
+
+    auto divider = uint64_t(DIVIDERS[SPCR & ((1 << SPR1) | (1 << SPR0))]);
+    if (SPSR & (1 << SPI2X))
+        divider /= 2;
+    Sim::advance(8 * divider);
+
+    ++sim.spiBytes;
+    SPSR = uint8_t(SPSR | (1 << SPIF));
+    return *this;
+}
+
+Timer1Counter::operator uint16_t() const
+{
+    Sim::advance(PORT_IO_CYCLES);
+    return timer1Running() ? uint16_t(sim.cycles / TIMER1_TICK_CYCLES) : 0;
+}
+
+AdcControlRegister& AdcControlRegister::operator=(const uint8_t value)
+{
+    static constexpr uint8_t PRESCALERS[] = { 2, 2, 4, 8, 16, 32, 64, 128 };
+
+    Sim::advance(PORT_IO_CYCLES);
+
+    /* ADSC can't be cleared by software, ADIF is cleared by writing a one to it */
+    auto next = uint8_t((value & ~(1 << ADIF)) | (bits & (1 << ADSC)));
+    if (!(value & (1 << ADIF)))
+        next = uint8_t(next | (bits & (1 << ADIF)));
+    if (!(next & (1 << ADEN))) {
+        next = uint8_t(next & ~(1 << ADSC));
+        sim.adcDoneAt = 0;
+        sim.adcStarted = false;
+    }
+    bits = next;
+
+    if ((bits & (1 << ADSC)) && !sim.adcDoneAt) {
+        /* The first conversion after enabling the ADC takes 25 ADC clocks, the others 13 */
+        const uint64_t adcClocks = sim.adcStarted ? 13 : 25;
+        sim.adcDoneAt = sim.cycles + adcClocks * PRESCALERS[bits & 0x07];
+        sim.adcStarted = true;
+    }
+    return *this;
+}
+
+u32 millis()
+{
+    Sim::advance(TIME_READ_CYCLES);
+    return u32(sim.cycles / Sim::CYCLES_PER_MS);
+}
+
+u32 micros()
+{
+    Sim::advance(TIME_READ_CYCLES);
+    return u32(sim.cycles / Sim::CYCLES_PER_US);
+}
+
+void delay(const unsigned long ms) { Sim::advance(ms * Sim::CYCLES_PER_MS); }
+
+void delayMicroseconds(const unsigned int us) { Sim::advance(us * Sim::CYCLES_PER_US); }
+
+void shiftOut(const uint8_t dataPin, const uint8_t clockPin, const uint8_t bitOrder,
+    const uint8_t value)
+{
+    for (uint8_t i = 0; i < 8; ++i) {
+        Sim::advance(SHIFT_OUT_BIT_CYCLES);
+        if (bitOrder == LSBFIRST)
+            digitalWrite(dataPin, !!(value & (1 << i)));
+        else
+            digitalWrite(dataPin, !!(value & (1 << (7 - i))));
+
+        digitalWrite(clockPin, HIGH);
+        digitalWrite(clockPin, LOW);
+    }
+}
+
+void tone(const uint8_t pin, const unsigned int, const unsigned long)
+{
+    Sim::advance(TONE_CYCLES);
+    sim.output[pin] = HIGH;
+}
+
+void noTone(const uint8_t pin)
+{
+    Sim::advance(TONE_CYCLES);
+    sim.output[pin] = LOW;
+}
+
+long random(const long howBig)
+{
+    Sim::advance(RANDOM_CYCLES);
+    if (howBig == 0)
+        return 0;
+
+    /* Park-Miller generator, like avr-libc's `random()` */
+    sim.randomState = uint32_t((uint64_t(sim.randomState) * 16807) % 2147483647);
+    return long(sim.randomState % uint32_t(howBig));
+}
+
+long random(const long howSmall, const long howBig)
+{
+    if (howSmall >= howBig)
+        return howSmall;
+    return random(howBig - howSmall) + howSmall;
+}
+
+void randomSeed(const unsigned long seed)
+{
+    if (seed != 0)
+        sim.randomState = uint32_t(seed % 2147483646) + 1;
+}
+
+long map(const long x, const long inMin, const long inMax, const long outMin,
+    const long outMax)
+{
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+/* Print */
+size_t Print::write(const uint8_t* buffer, size_t size)
+{
+    size_t n = 0;
+    while (size--)
+        n += write(*buffer++);
+    return n;
+}
+
+size_t Print::print(const long n, const int base)
+{
+    if (base == DEC && n < 0)
+        return print('-') + printNumber((unsigned long)(-n), DEC);
+    return printNumber((unsigned long)n, uint8_t(base));
+}
+
+size_t Print::print(const unsigned long n, const int base)
+{
+    return printNumber(n, uint8_t(base));
+}
+
+size_t Print::print(double n, const int digits)
+{
+    size_t count = 0;
+    if (n < 0.0) {
+        count += print('-');
+        n = -n;
+    }
+
+    const auto integer = (unsigned long)n;
+    count += print(integer);
+    if (digits > 0)
+        count += print('.');
+
+    double remainder = n - double(integer);
+    for (int i = 0; i < digits; ++i) {
+        remainder *= 10.0;
+        const auto digit = unsigned(remainder);
+        count += print(char('0' + digit));
+        remainder -= digit;
+    }
+
+    return count;
+}
+
+size_t Print::printNumber(unsigned long n, uint8_t base)
+{
+    char buffer[8 * sizeof(long) + 1];
+    char* str = &buffer[sizeof(buffer) - 1];
+    *str = '\0';
+
+    if (base < 2)
+        base = 10;
+
+    do {
+        const auto digit = char(n % base);
+        n /= base;
+        *--str = char(digit < 10 ? digit + '0' : digit + 'A' - 10);
+    } while (n);
+
+    return write(str);
+}
+
+/* HardwareSerial: transmission is paced by the baud rate and blocks once the buffer is full */
+void HardwareSerial::begin(const unsigned long baud)
+{
+    static constexpr uint64_t BITS_PER_FRAME = 10;
+    sim.serialCyclesPerByte = Sim::CPU_FREQUENCY * BITS_PER_FRAME / baud;
+}
+
+int HardwareSerial::available() { return 0; }
+
+int HardwareSerial::read() { return -1; }
+
+int HardwareSerial::availableForWrite()
+{
+    if (sim.serialIdleAt <= sim.cycles)
+        return int(SERIAL_TX_BUFFER_SIZE - 1);
+
+    const auto pending = (sim.serialIdleAt - sim.cycles + sim.serialCyclesPerByte - 1)
+        / sim.serialCyclesPerByte;
+    return pending >= SERIAL_TX_BUFFER_SIZE - 1 ? 0 : int(SERIAL_TX_BUFFER_SIZE - 1 - pending);
+}
+
+void HardwareSerial::flush()
+{
+    if (sim.serialIdleAt > sim.cycles)
+        Sim::advance(sim.serialIdleAt - sim.cycles);
+}
+
+size_t HardwareSerial::write(const uint8_t byte)
+{
+    const auto bufferSpan = SERIAL_TX_BUFFER_SIZE * sim.serialCyclesPerByte;
+
+    if (sim.serialIdleAt < sim.cycles)
+        sim.serialIdleAt = sim.cycles;
+    if (sim.serialIdleAt > sim.cycles + bufferSpan)
+        Sim::advance(sim.serialIdleAt - bufferSpan - sim.cycles);
+    sim.serialIdleAt += sim.serialCyclesPerByte;
+
+    if (sim.serialOutput)
+        fputc(byte, sim.serialOutput);
+    return 1;
+}
+
+/* EEPROM: erased (0xFF) at power-on, writes block until the cell is programmed */
+uint8_t EEPROMClass::read(const int addr)
+{
+    Sim::advance(EEPROM_READ_CYCLES);
+    return cells[addr];
+}
+
+void EEPROMClass::write(const int addr, const uint8_t value)
+{
+    Sim::advance(EEPROM_WRITE_CYCLES);
+    cells[addr] = value;
+}
+
+void EEPROMClass::update(const int addr, const uint8_t value)
+{
+    if (read(addr) != value)
+        write(addr, value);
+}
+
+EEPROMClass::EEPROMClass() { memset(cells, 0xFF, sizeof(cells)); }
@@ -0,0 +1,207 @@
+/*
+ *  Runs the hw-5 sketch against the host-side Arduino core, with a scripted joystick, and
+ *  reports how fast `loop()` spins, whether input was lost and how much memory it takes.
+ *
+ *  Usage: `$ ./bin/hw-5-sim [simulated seconds] [serial output file]`
+ */
+
+#include "../common/boot.h"
+#include "../common/latency.h"
+#include "../common/scheduler.h"
+#include "../hw-5/JoystickController.h"
+#include "core/Sim.h"
+#include "hw-5-memory.h"
+#include <chrono>
+#include <ucontext.h>
+
+void setup();
+void loop();
+
+namespace {
+enum class Gesture : u8 {
+    Left = 0,
+    Right,
+    Up,
+    Down,
+    Wait,
+};
+
+/* A gesture holds the stick for `HOLD_DURATION` and then releases it for `RELEASE_DURATION` */
+constexpr u32 HOLD_DURATION = 150;
+constexpr u32 RELEASE_DURATION = 150;
+constexpr u32 GREETING_DURATION = 5500;
+constexpr u16 AXIS_LOW = 0;
+constexpr u16 AXIS_MIDDLE = 512;
+constexpr u16 AXIS_HIGH = 1023;
+
+/*
+ *  One round of the script: play a game and walk off the right edge of the matrix, wait for
+ *  the game over screen to time out, then change the contrast from the settings menu. The
+ *  round ends in the main menu, so it can be repeated.
+ */
+constexpr Gesture SCRIPT[] = {
+    Gesture::Right, /* Start game */
+    Gesture::Left, Gesture::Up, Gesture::Left, Gesture::Up, Gesture::Left, Gesture::Up,
+    Gesture::Left, Gesture::Up, Gesture::Left, Gesture::Up, Gesture::Left, Gesture::Up,
+    Gesture::Left, Gesture::Up,
+    Gesture::Left, /* Game over */
+    Gesture::Wait, Gesture::Wait, Gesture::Wait, Gesture::Wait, Gesture::Wait,
+    Gesture::Wait, Gesture::Wait, Gesture::Wait, Gesture::Wait, Gesture::Wait,
+    Gesture::Wait, Gesture::Wait, Gesture::Wait, Gesture::Wait, Gesture::Wait,
+    Gesture::Wait, Gesture::Wait, Gesture::Wait,
+    Gesture::Up,    /* Main menu: "Settings" */
+    Gesture::Right, /* Settings */
+    Gesture::Right, /* Contrast slider */
+    Gesture::Up, Gesture::Up, Gesture::Up, Gesture::Down, Gesture::Down,
+    Gesture::Left, /* Settings */
+    Gesture::Left, /* Main menu */
+};
+constexpr u32 NUM_GESTURES = sizeof(SCRIPT) / sizeof(SCRIPT[0]);
+constexpr u32 GESTURE_DURATION = HOLD_DURATION + RELEASE_DURATION;
+
+void applyStimulus(const u32 currentTs)
+{
+    u16 x = AXIS_MIDDLE;
+    u16 y = AXIS_MIDDLE;
+
+    if (currentTs >= GREETING_DURATION) {
+        const auto scriptTs = currentTs - GREETING_DURATION;
+        const auto gesture = SCRIPT[(scriptTs / GESTURE_DURATION) % NUM_GESTURES];
+
+        if (scriptTs % GESTURE_DURATION < HOLD_DURATION) {
+            switch (gesture) {
+            case Gesture::Left:
+                x = AXIS_LOW;
+                break;
+            case Gesture::Right:
+                x = AXIS_HIGH;
+                break;
+            case Gesture::Up:
+                y = AXIS_HIGH;
+                break;
+            case Gesture::Down:
+                y = AXIS_LOW;
+                break;
+            case Gesture::Wait:
+                break;
+            }
+        }
+    }
+
+    Sim::setAnalogInput(A0, x);
+    Sim::setAnalogInput(A1, y);
+}
+
+u32 currentMs() { return u32(Sim::cycles() / Sim::CYCLES_PER_MS); }
+
+/*
+ *  The sketch runs on its own stack, painted beforehand like `common/memory.h` does on the
+ *  board, so that the deepest it got can be found afterwards.
+ */
+constexpr size_t SKETCH_STACK_SIZE = 1 << 20;
+constexpr u8 STACK_PAINT = 0xC5;
+
+alignas(16) u8 sketchStack[SKETCH_STACK_SIZE];
+ucontext_t driverContext;
+ucontext_t sketchContext;
+
+struct {
+    uint64_t endCycles;
+    uint64_t iterations;
+} run;
+
+void runSketch()
+{
+    setup();
+    while (Sim::cycles() < run.endCycles) {
+        applyStimulus(currentMs());
+        loop();
+        ++run.iterations;
+    }
+}
+
+size_t sketchStackUsed()
+{
+    size_t untouched = 0;
+    while (untouched < SKETCH_STACK_SIZE && sketchStack[untouched] == STACK_PAINT)
+        ++untouched;
+    return SKETCH_STACK_SIZE - untouched;
+}
+}
+
+int main(int argc, char** argv)
+{
+    using WallClock = std::chrono::steady_clock;
+
+    const double simulatedSeconds = argc > 1 ? atof(argv[1]) : 60.0;
+    if (simulatedSeconds <= 0.0 || argc > 3) {
+        fprintf(stderr, "usage: %s [simulated seconds] [serial output file]\n", argv[0]);
+        return 1;
+    }
+
+    FILE* serialOutput = nullptr;
+    if (argc > 2 && !(serialOutput = fopen(argv[2], "wb"))) {
+        perror(argv[2]);
+        return 1;
+    }
+    Sim::setSerialOutput(serialOutput);
+
+    init();
+    applyStimulus(currentMs());
+
+    memset(sketchStack, STACK_PAINT, sizeof(sketchStack));
+    getcontext(&sketchContext);
+    sketchContext.uc_stack.ss_sp = sketchStack;
+    sketchContext.uc_stack.ss_size = sizeof(sketchStack);
+    sketchContext.uc_link = &driverContext;
+    makecontext(&sketchContext, runSketch, 0);
+
+    const auto startCycles = Sim::cycles();
+    run.endCycles = startCycles + uint64_t(simulatedSeconds * double(Sim::CPU_FREQUENCY));
+
+    const auto wallStart = WallClock::now();
+    swapcontext(&driverContext, &sketchContext);
+    const auto wallEnd = WallClock::now();
+
+    const auto iterations = run.iterations;
+    const auto stackUsed = sketchStackUsed();
+
+    const auto wallNs = double(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(wallEnd - wallStart).count());
+    const auto elapsedSeconds
+        = double(Sim::cycles() - startCycles) / double(Sim::CPU_FREQUENCY);
+
+    printf("simulated time:              %.3f s\n", elapsedSeconds);
+    printf("wall-clock time:             %.3f s (%.0fx real time)\n", wallNs / 1e9,
+        elapsedSeconds * 1e9 / wallNs);
+    printf("loop() iterations:           %llu\n", (unsigned long long)iterations);
+    printf("iterations / simulated s:    %.1f\n", double(iterations) / elapsedSeconds);
+    printf("simulated us / iteration:    %.1f\n", elapsedSeconds * 1e6 / double(iterations));
+    printf("wall-clock ns / iteration:   %.1f\n", wallNs / double(iterations));
+    printf("input events dropped:        %u\n", JoystickController::droppedEvents());
+
+    /*
+     *  Host sizes, which overestimate the board's (pointers take 8 bytes instead of 2, and the
+     *  stack includes the simulated core): compare them between revisions, not with the 2 KB
+     *  of SRAM. `common/memory.h` measures the real headroom on the board.
+     */
+    printf("static data (host):          %d B data, %d B bss\n", SKETCH_DATA_SIZE,
+        SKETCH_BSS_SIZE);
+    printf("stack high-water (host):     %zu B\n", stackUsed);
+
+    if (serialOutput)
+        fclose(serialOutput);
+
+#ifdef INSTRUMENT_LATENCY
+    Sim::setSerialOutput(stdout);
+    Latency::report();
+#endif
+#ifdef INSTRUMENT_TASKS
+    Sim::setSerialOutput(stdout);
+    Scheduler::report();
+#endif
+#ifdef INSTRUMENT_BOOT
+    Sim::setSerialOutput(stdout);
+    Boot::report();
+#endif
+}
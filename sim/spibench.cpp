@@ -0,0 +1,119 @@
+/*
+ *  Compares the simulated cost of the ways the sketches can feed their shift-register chips:
+ *  `shiftOut()` (what `LedControl` and the old hw-4 code do), `Spi::BitBang` on `FastPin`
+ *  pins and the SPI peripheral (`Spi::Hardware`).
+ *
+ *  Usage: `$ ./bin/spibench`
+ */
+
+#include "../common/hc595.h"
+#include "../common/max7219.h"
+#include "core/LedControl.h"
+#include "core/Sim.h"
+
+namespace {
+constexpr u8 DATA_PIN = 12;
+constexpr u8 CLOCK_PIN = 11;
+constexpr u8 LATCH_PIN = 10;
+constexpr u32 NUM_REPEATS = 1000;
+
+using BitBangBus = Spi::BitBang<DATA_PIN, CLOCK_PIN>;
+using HardwareBus = Spi::Hardware<>;
+
+template <typename F> double cyclesPer(const u32 numRepeats, F run)
+{
+    const auto start = Sim::cycles();
+    for (u32 i = 0; i < numRepeats; ++i)
+        run(u8(i));
+    return double(Sim::cycles() - start) / numRepeats;
+}
+
+void printRow(const char* path, const double cycles, const char* unit)
+{
+    printf("  %-22s %8.1f cycles %10.0f %s/s\n", path, cycles,
+        double(Sim::CPU_FREQUENCY) / cycles, unit);
+}
+
+/* A full frame of a chain, one transfer per device and row, then one per row */
+template <typename Bus, u8 NUM_DEVICES> void printChain()
+{
+    using Chain = Max7219<Bus, LATCH_PIN, NUM_DEVICES>;
+    static Chain chain;
+    static u8 rows[NUM_DEVICES];
+
+    const auto perDevice = cyclesPer(NUM_REPEATS, [](const u8 value) {
+        for (u8 row = 0; row < Chain::NUM_ROWS; ++row)
+            for (u8 device = 0; device < NUM_DEVICES; ++device)
+                chain.setRow(device, row, value);
+    });
+    const auto perRow = cyclesPer(NUM_REPEATS, [](const u8 value) {
+        for (auto& bits : rows)
+            bits = value;
+        for (u8 row = 0; row < Chain::NUM_ROWS; ++row)
+            chain.setRows(row, rows);
+    });
+    printf("  %u device(s) %14.1f cycles %12.1f cycles %7.1f us/device\n", NUM_DEVICES,
+        perDevice, perRow, perRow / Sim::CYCLES_PER_US / NUM_DEVICES);
+}
+}
+
+int main()
+{
+    pinMode(DATA_PIN, OUTPUT);
+    pinMode(CLOCK_PIN, OUTPUT);
+    pinMode(LATCH_PIN, OUTPUT);
+    BitBangBus::begin();
+    HardwareBus::begin();
+
+    printf("byte:\n");
+    printRow("shiftOut", cyclesPer(NUM_REPEATS, [](const u8 value) {
+        shiftOut(DATA_PIN, CLOCK_PIN, MSBFIRST, value);
+    }), "bytes");
+    printRow("Spi::BitBang", cyclesPer(NUM_REPEATS, BitBangBus::transfer), "bytes");
+    printRow("Spi::Hardware", cyclesPer(NUM_REPEATS, HardwareBus::transfer), "bytes");
+
+    /* hw-4: one section of the 4-digit display per refresh interrupt */
+    printf("74HC595 section:\n");
+    printRow("shiftOut", cyclesPer(NUM_REPEATS, [](const u8 value) {
+        digitalWrite(LATCH_PIN, LOW);
+        shiftOut(DATA_PIN, CLOCK_PIN, LSBFIRST, value);
+        digitalWrite(LATCH_PIN, HIGH);
+    }), "sections");
+    printRow("Hc595<BitBang>", cyclesPer(NUM_REPEATS, Hc595<BitBangBus, LATCH_PIN>::write),
+        "sections");
+    printRow("Hc595<Hardware>", cyclesPer(NUM_REPEATS, Hc595<HardwareBus, LATCH_PIN>::write),
+        "sections");
+
+    /* hw-5: all 8 rows of the matrix */
+    printf("MAX7219 frame:\n");
+    static LedControl lc(DATA_PIN, CLOCK_PIN, LATCH_PIN, 1);
+    static Max7219<BitBangBus, LATCH_PIN> bitBangMatrix;
+    static Max7219<HardwareBus, LATCH_PIN> hardwareMatrix;
+    printRow("LedControl", cyclesPer(NUM_REPEATS, [](const u8 value) {
+        for (u8 row = 0; row < 8; ++row)
+            lc.setRow(0, row, value);
+    }), "frames");
+    printRow("Max7219<BitBang>", cyclesPer(NUM_REPEATS, [](const u8 value) {
+        for (u8 row = 0; row < 8; ++row)
+            bitBangMatrix.setRow(0, row, value);
+    }), "frames");
+    printRow("Max7219<Hardware>", cyclesPer(NUM_REPEATS, [](const u8 value) {
+        for (u8 row = 0; row < 8; ++row)
+            hardwareMatrix.setRow(0, row, value);
+    }), "frames");
+
+    /* hw-5 with `MATRICES`: a frame should cost per byte sent, not per transfer */
+    printf("MAX7219 chain frame:  setRow per device    setRows per row\n");
+    printf(" BitBang\n");
+    printChain<BitBangBus, 1>();
+    printChain<BitBangBus, 2>();
+    printChain<BitBangBus, 4>();
+    printChain<BitBangBus, 8>();
+    printf(" Hardware\n");
+    printChain<HardwareBus, 1>();
+    printChain<HardwareBus, 2>();
+    printChain<HardwareBus, 4>();
+    printChain<HardwareBus, 8>();
+
+    return 0;
+}
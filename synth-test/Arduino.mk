@@ -0,0 +1 @@
+../common/Arduino.mk
\ No newline at end of file
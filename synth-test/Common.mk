@@ -0,0 +1 @@
+../common/Common.mk
\ No newline at end of file
@@ -0,0 +1,42 @@
+/*
+ *  The fugue on two voices of `common/synth.h`, the second an octave lower, like an organ's
+ *  16' stop. Pin 3 carries 62.5 kHz PWM: put an RC low-pass between it and the speaker.
+ */
+
+#include "common/bench.h"
+#include "common/console.h"
+#include "common/synth.h"
+#include <avr/sleep.h>
+
+using Organ = Dds::Synth<2>;
+
+ISR(TIMER1_COMPB_vect) { Organ::sample(); }
+ISR(TIMER0_COMPA_vect) { Organ::tick(); }
+
+void setup()
+{
+    Console::begin();
+    Organ::begin();
+    Organ::play(0, PART(LITTLE_FUGUE_IN_G_MINOR, 10000));
+    Organ::play(1, PART(LITTLE_FUGUE_IN_G_MINOR, 10000), 1);
+}
+
+/* The voices play from interrupts, which wake the CPU up */
+void loop()
+{
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sleep_enable();
+    sleep_cpu();
+    sleep_disable();
+}
+
+int main()
+{
+    init();
+    setup();
+    for (;;) {
+        Bench::markLoop();
+        loop();
+        Console::poll();
+    }
+}
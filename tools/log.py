@@ -0,0 +1,139 @@
+#!/usr/bin/env python3
+"""
+Decodes the binary stream of the tokenized logger (`common/log.h`).
+
+Usage:
+    $ tools/log.py hw-5/bin/hw-5.elf /dev/ttyACM0   # follow the board's log
+    $ tools/log.py hw-5/bin/hw-5.elf capture.bin    # or decode a raw capture
+
+The format strings are read from the `.logstr` section of the ELF the board was flashed with.
+Don't send console commands while the log is being followed: their text replies are mixed
+into the binary stream.
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+from serial_port import is_tty, open_raw
+
+DROPPED_ID = 0xFFFF
+PLACEHOLDER = re.compile(r"\{(u8|u16|u32|i8|i16|i32|x8|x16|x32|b)\}")
+FORMATS = {
+    "u8": ("<B", "{}"), "u16": ("<H", "{}"), "u32": ("<I", "{}"),
+    "i8": ("<b", "{}"), "i16": ("<h", "{}"), "i32": ("<i", "{}"),
+    "x8": ("<B", "0x{:02x}"), "x16": ("<H", "0x{:04x}"), "x32": ("<I", "0x{:08x}"),
+    "b": ("<B", "{}"),
+}
+
+
+def read_section(elf, name):
+    with open(elf, "rb") as file:
+        data = file.read()
+    if data[:4] != b"\x7fELF" or data[4] != 1 or data[5] != 1:
+        sys.exit(f"error: {elf} isn't a little-endian ELF32 file")
+
+    shoff, = struct.unpack_from("<I", data, 0x20)
+    shentsize, shnum, shstrndx = struct.unpack_from("<HHH", data, 0x2E)
+
+    def header(index):
+        return struct.unpack_from("<IIIIIIIIII", data, shoff + index * shentsize)
+
+    names_offset = header(shstrndx)[4]
+    for index in range(shnum):
+        name_offset, _, _, _, offset, size = header(index)[:6]
+        end = data.index(b"\0", names_offset + name_offset)
+        if data[names_offset + name_offset:end].decode() == name:
+            return data[offset:offset + size]
+    sys.exit(f"error: {elf} has no {name} section (was it built with LOG?)")
+
+
+def read_formats(section):
+    formats = {}
+    offset = 0
+    while offset < len(section):
+        end = section.index(b"\0", offset)
+        formats[offset] = section[offset:end].decode("ascii", "replace")
+        offset = end + 1
+    return formats
+
+
+class Truncated(Exception):
+    pass
+
+
+def decode(formats, stream):
+    """Yields one line of text per record. Bytes that don't start a record are skipped."""
+    buffer = b""
+
+    def take(size):
+        nonlocal buffer
+        while len(buffer) < size:
+            chunk = next(stream, b"")
+            if not chunk:
+                return None
+            buffer += chunk
+        data, buffer = buffer[:size], buffer[size:]
+        return data
+
+    while True:
+        data = take(2)
+        if data is None:
+            return
+        record_id, = struct.unpack("<H", data)
+
+        if record_id == DROPPED_ID:
+            data = take(2)
+            if data is None:
+                return
+            yield f"<{struct.unpack('<H', data)[0]} records dropped>"
+            continue
+
+        if record_id not in formats:
+            buffer = data[1:] + buffer  # Out of sync, try the next byte
+            continue
+
+        def replace(match):
+            pack, text = FORMATS[match.group(1)]
+            value = take(struct.calcsize(pack))
+            if value is None:
+                raise Truncated
+            value, = struct.unpack(pack, value)
+            return text.format(bool(value) if match.group(1) == "b" else value)
+
+        try:
+            yield PLACEHOLDER.sub(replace, formats[record_id])
+        except Truncated:
+            return
+
+
+def chunks(fd):
+    while True:
+        chunk = os.read(fd, 256)
+        if not chunk:
+            return
+        yield chunk
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("elf", help="firmware the log comes from")
+    parser.add_argument("log", help="serial port of the board, or a raw capture")
+    args = parser.parse_args()
+
+    formats = read_formats(read_section(args.elf, ".logstr"))
+    fd = open_raw(args.log) if is_tty(args.log) else os.open(args.log, os.O_RDONLY)
+    try:
+        for line in decode(formats, chunks(fd)):
+            print(line, flush=True)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        os.close(fd)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,141 @@
+#!/usr/bin/env python3
+"""
+Symbolizes a histogram dumped by the statistical profiler (`common/profiler.h`).
+
+Usage:
+    $ tools/profile.py hw-5/bin/hw-5.elf /dev/ttyACM0   # request a dump from the board
+    $ tools/profile.py hw-5/bin/hw-5.elf dump.txt       # or read a captured dump
+
+Each histogram bin covers a range of the flash. Its samples are split between the functions
+overlapping that range, proportionally to the overlap.
+
+Opening the serial port resets the board, which clears the histogram, so a dump requested from
+the board covers the time since that reset: the tool waits `--seconds` (longer than the
+bootloader's wait, until the sketch's console is up) before sending `p`.
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+import termios
+import time
+
+from serial_port import is_tty, open_raw
+
+
+# Until the bootloader has started the sketch, after the reset that opening the port causes
+BOOT_SECONDS = 2.0
+
+
+def read_dump_from_tty(path, seconds):
+    fd = open_raw(path)
+    time.sleep(max(seconds, BOOT_SECONDS))
+    termios.tcflush(fd, termios.TCIFLUSH)
+    os.write(fd, b"p")
+    data = b""
+    while b"# end" not in data:
+        chunk = os.read(fd, 256)
+        if not chunk:
+            break
+        data += chunk
+    os.close(fd)
+
+    return data.decode("ascii", "replace").splitlines()
+
+
+def parse_dump(lines):
+    header = {}
+    bins = {}
+    inside = False
+    for line in lines:
+        line = line.strip()
+        if line == "# profile":
+            inside = True
+            header, bins = {}, {}
+        elif line == "# end":
+            inside = False
+        elif inside and line:
+            key, value = line.split()
+            if key.isdigit():
+                bins[int(key)] = int(value)
+            else:
+                header[key] = int(value)
+
+    if "shift" not in header:
+        sys.exit("error: no profile dump found")
+    return header, bins
+
+
+def read_functions(nm, elf):
+    output = subprocess.run([nm, "--numeric-sort", "--print-size", "--demangle",
+                             "--defined-only", elf], check=True, capture_output=True,
+                            text=True).stdout
+    functions = []
+    for line in output.splitlines():
+        fields = line.split(maxsplit=2)
+        if len(fields) == 3 and len(fields[1]) == 1:
+            address, kind, name = fields
+            size = "0"
+        else:
+            fields = line.split(maxsplit=3)
+            if len(fields) != 4:
+                continue
+            address, size, kind, name = fields
+        if kind in ("t", "T", "w", "W"):
+            functions.append((int(address, 16), int(size, 16), name))
+
+    # Symbols without a size (e.g. from assembly) extend up to the next symbol
+    for i, (start, size, name) in enumerate(functions):
+        if not size and i + 1 < len(functions):
+            functions[i] = (start, functions[i + 1][0] - start, name)
+    return functions
+
+
+def attribute(header, bins, functions):
+    bin_bytes = 2 << header["shift"]
+    samples = {}
+    for index, count in bins.items():
+        low, high = index * bin_bytes, (index + 1) * bin_bytes
+        overlaps = [(min(high, start + size) - max(low, start), name)
+                    for start, size, name in functions
+                    if start < high and start + size > low]
+        covered = sum(overlap for overlap, _ in overlaps)
+        if not covered:
+            samples["<unknown>"] = samples.get("<unknown>", 0) + count
+            continue
+        for overlap, name in overlaps:
+            samples[name] = samples.get(name, 0) + count * overlap / covered
+    return samples
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("elf", help="firmware the dump was taken from")
+    parser.add_argument("dump", help="serial port of the board, or a captured dump")
+    parser.add_argument("--nm", default="avr-nm", help="nm of the AVR toolchain")
+    parser.add_argument("--top", type=int, default=25, help="number of functions shown")
+    parser.add_argument("--seconds", type=float, default=10.0,
+                        help=f"profiling time from the reset, {BOOT_SECONDS} s at least")
+    args = parser.parse_args()
+
+    if is_tty(args.dump):
+        lines = read_dump_from_tty(args.dump, args.seconds)
+    else:
+        with open(args.dump) as file:
+            lines = file.read().splitlines()
+
+    header, bins = parse_dump(lines)
+    samples = attribute(header, bins, read_functions(args.nm, args.elf))
+    total = header["samples"]
+
+    print(f"{total} samples, {header['outside']} outside .text, "
+          f"{2 << header['shift']} bytes per bin")
+    print(f"{'samples':>10} {'%':>6}  function")
+    for name, count in sorted(samples.items(), key=lambda item: -item[1])[:args.top]:
+        print(f"{count:10.1f} {100.0 * count / max(total, 1):6.2f}  {name}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,32 @@
+"""
+Serial port helpers shared by the host tools.
+"""
+
+import os
+import termios
+
+BAUDRATE = termios.B9600  # `Console::BAUDRATE` in `common/console.h`
+
+
+def is_tty(path):
+    if not os.path.exists(path):
+        return False
+    fd = os.open(path, os.O_RDONLY | os.O_NOCTTY | os.O_NONBLOCK)
+    try:
+        return os.isatty(fd)
+    finally:
+        os.close(fd)
+
+
+def open_raw(path):
+    """Opens a serial port in raw mode and returns its file descriptor."""
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+    attrs = termios.tcgetattr(fd)
+    attrs[0] = 0                                  # iflag
+    attrs[1] = 0                                  # oflag
+    attrs[2] = termios.CS8 | termios.CREAD | termios.CLOCAL
+    attrs[3] = 0                                  # lflag
+    attrs[4] = attrs[5] = BAUDRATE
+    termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    termios.tcflush(fd, termios.TCIOFLUSH)
+    return fd
@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+"""
+Captures, prints and compiles input traces (`common/trace.h`).
+
+Usage:
+    $ tools/trace.py capture /dev/ttyACM0 game.trace    # record from a `TRACE` build, ^C to stop
+    $ tools/trace.py show game.trace                    # print the records
+    $ tools/trace.py header game.trace > hw-5/replay.h  # compile it into a `REPLAY` build
+
+Opening the serial port resets the board, so a capture starts at reset, like the timestamps.
+The simulator writes traces directly: `make -C sim run INSTRUMENTATION=TRACE SERIAL=F`.
+"""
+
+import argparse
+import os
+import sys
+
+from serial_port import open_raw
+
+# hw-5's packing of `JoystickController::Press` and `JoystickController::Direction`
+PRESSES = ["None", "Short", "Long"]
+DIRECTIONS = ["None", "Up", "Down", "Left", "Right"]
+
+
+def parse(data):
+    """Yields the absolute timestamp and input of each record."""
+    offset = 0
+    timestamp = 0
+    while offset < len(data):
+        delta = shift = 0
+        while True:
+            if offset >= len(data):
+                sys.exit("error: trace ends in the middle of a record")
+            byte = data[offset]
+            offset += 1
+            delta |= (byte & 0x7F) << shift
+            shift += 7
+            if not byte & 0x80:
+                break
+        if offset >= len(data):
+            sys.exit("error: trace ends in the middle of a record")
+        timestamp += delta
+        yield timestamp, data[offset]
+        offset += 1
+
+
+def describe(value):
+    press, direction = value >> 4, value & 0x0F
+    names = []
+    if press:
+        names.append(f"press {PRESSES[press] if press < len(PRESSES) else press}")
+    if direction:
+        names.append(DIRECTIONS[direction] if direction < len(DIRECTIONS) else str(direction))
+    return ", ".join(names)
+
+
+def capture(args):
+    fd = open_raw(args.port)
+    size = 0
+    with open(args.trace, "wb") as file:
+        try:
+            while True:
+                chunk = os.read(fd, 256)
+                if not chunk:
+                    break
+                file.write(chunk)
+                file.flush()
+                size += len(chunk)
+        except KeyboardInterrupt:
+            pass
+        finally:
+            os.close(fd)
+    print(f"{size} bytes captured", file=sys.stderr)
+
+
+def show(args):
+    with open(args.trace, "rb") as file:
+        data = file.read()
+    for timestamp, value in parse(data):
+        print(f"{timestamp:10} ms  0x{value:02x}  {describe(value)}")
+
+
+def header(args):
+    with open(args.trace, "rb") as file:
+        data = file.read()
+    records = sum(1 for _ in parse(data))
+
+    print(f"/* Generated by `tools/trace.py header {args.trace}`: {records} records */")
+    print()
+    print("#pragma once")
+    print("#include <Arduino.h>")
+    print()
+    print("static const u8 REPLAY_TRACE[] PROGMEM = {")
+    for i in range(0, len(data), 12):
+        print("    " + " ".join(f"0x{byte:02x}," for byte in data[i:i + 12]))
+    print("};")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    command = commands.add_parser("capture", help="record a trace from the board")
+    command.add_argument("port", help="serial port of the board")
+    command.add_argument("trace", help="output file")
+    command.set_defaults(run=capture)
+
+    command = commands.add_parser("show", help="print a trace")
+    command.add_argument("trace")
+    command.set_defaults(run=show)
+
+    command = commands.add_parser("header", help="print a trace as a C++ header")
+    command.add_argument("trace")
+    command.set_defaults(run=header)
+
+    args = parser.parse_args()
+    args.run(args)
+
+
+if __name__ == "__main__":
+    main()